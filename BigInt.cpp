@@ -1,282 +1,822 @@
-#include <iostream>
-#include <algorithm>
-#include <cassert>
-#include <sstream>
-#include <utility>
-#include <cstdlib>
+#include "BigInt.h"
 
 
-class NumberString {
-public:
-    NumberString(long long number) {
-        std::stringstream ss; ss << std::abs(number); ss >> strRepresent;
-        isNegative = number < 0;
-    };
+// Every heap allocation made through operator new is counted, so the benchmarks
+// can report allocations per operation; limb buffers served from the MemoryPool
+// free lists do not reach operator new and are not counted.
+std::atomic<size_t> heapAllocationCount{ 0 };
 
-    NumberString(const char* strNum = "0") : strRepresent(strNum), isNegative(false) {
-        assert(strNum != "");
-        if (strRepresent.front() == '-') {
-            strRepresent = strRepresent.substr(1);
-            isNegative = true;
-        }
+// These replacements pair malloc and aligned_alloc with free by design. Once they
+// are inlined into the library code of this file, GCC sees a pointer from
+// operator new reaching free and reports a mismatch that cannot happen: every
+// allocation and deallocation function here goes through the same allocator.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(size_t bytes) {
+    heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* block = std::malloc(bytes != 0 ? bytes : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment) {
+    heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    auto alignmentBytes = static_cast<size_t>(alignment);
+    if (void* block = std::aligned_alloc(alignmentBytes, (bytes + alignmentBytes - 1) / alignmentBytes * alignmentBytes
+                                                          + (bytes == 0) * alignmentBytes)) {
+        return block;
     }
+    throw std::bad_alloc();
+}
 
-    NumberString(NumberString const&) = default;
-    ~NumberString() = default;
+void operator delete(void* block) noexcept { std::free(block); }
+void operator delete(void* block, size_t) noexcept { std::free(block); }
+void operator delete(void* block, std::align_val_t) noexcept { std::free(block); }
+void operator delete(void* block, size_t, std::align_val_t) noexcept { std::free(block); }
 
+#pragma GCC diagnostic pop
 
-    [[nodiscard]] std::string Get() const noexcept {
-        return (this->isNegative ? "-" : "") + strRepresent;
-    }
 
-    NumberString& operator= (NumberString const&) = default;
+// Google Benchmark style suite for the NumberString operators. Every operation is
+// timed at operand sizes from 10 digits up to maxDigits in powers of ten, and the
+// iteration count of a measurement grows until one batch runs for at least minTime
+// seconds. The report gives ns/op, digits/s and heap allocations per op, on the
+// console and optionally as JSON that can be diffed between builds.
+class BenchmarkSuite final {
+public:
+    struct Result {
+        std::string name;
+        size_t digits;
+        size_t iterations;
+        double nanosecondsPerOp;
+        double digitsPerSecond;
+        double allocationsPerOp;
+        size_t threads;
+    };
 
-    friend NumberString operator+ (NumberString firstNum, NumberString secondNum);
-    friend NumberString operator- (NumberString firstNum, NumberString secondNum);
-    friend NumberString operator* (NumberString firstNum, NumberString secondNum);
-    friend NumberString operator/ (NumberString firstNum, NumberString secondNum);
-    friend NumberString operator% (const NumberString& firstNum, const NumberString& secondNum);
-    friend NumberString operator^ (const NumberString& number, const NumberString& power);
-    friend NumberString operator! (const NumberString& number);
+public:
+    // The suite runs with the first of threadCounts; when more are given, the
+    // parallel paths are also timed with each of them.
+    BenchmarkSuite(size_t _maxDigits, double _minTime, std::string _filter, std::vector<size_t> _threadCounts)
+            : maxDigits(_maxDigits), minTime(_minTime), filter(std::move(_filter)),
+              threadCounts(std::move(_threadCounts)) {}
 
+    void Run();
+    void WriteJson(std::ostream& out) const;
 
-    NumberString& operator+= (const NumberString& other) {
-        return *this = *this + other;
-    }
-    NumberString& operator-= (const NumberString& other) {
-        return *this = *this - other;
+    [[nodiscard]] std::vector<Result> const& GetResults() const noexcept { return results; }
+
+private:
+    void RunMultiplyTiers();
+    void RunThreadScaling();
+    void RunAddKernels();
+    void RunNumberTheory();
+
+    template<class Operation> void Measure(std::string const& operation, size_t digits, Operation&& body);
+
+    template<class T> static void DoNotOptimize(T const& value) noexcept {
+#if defined(__GNUC__)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        static void const* volatile sink;
+        sink = &value;
+#endif
     }
-    NumberString& operator*= (const NumberString& other) {
-        return *this = *this * other;
+
+    std::string RandomDigits(size_t digits);
+
+private:
+    size_t maxDigits;
+    double minTime;
+    std::string filter;
+    std::vector<size_t> threadCounts;
+    std::mt19937_64 generator{ 42 };
+    std::vector<Result> results;
+};
+
+std::string BenchmarkSuite::RandomDigits(size_t digits) {
+    std::string text(std::max<size_t>(digits, 1), '0');
+    for (char& digit : text) {
+        digit = static_cast<char>('0' + generator() % 10);
     }
-    NumberString& operator/= (const NumberString& other) {
-        return *this = *this / other;
+    text.front() = static_cast<char>('1' + generator() % 9);
+    return text;
+}
+
+template<class Operation>
+void BenchmarkSuite::Measure(std::string const& operation, size_t digits, Operation&& body) {
+    std::string name = operation + "/" + std::to_string(digits);
+    if (!filter.empty() && name.find(filter) == std::string::npos) {
+        return;
     }
-    NumberString& operator%= (const NumberString& other) {
-        return *this = *this % other;
+
+    constexpr size_t maxIterations = 1'000'000'000;
+    for (size_t iterations = 1; ; ) {
+        size_t allocations = heapAllocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            body();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        allocations = heapAllocationCount.load(std::memory_order_relaxed) - allocations;
+
+        if (elapsed.count() >= minTime || iterations >= maxIterations) {
+            double seconds = elapsed.count() / static_cast<double>(iterations);
+            results.push_back({ name, digits, iterations, seconds * 1e9, static_cast<double>(digits) / seconds,
+                                static_cast<double>(allocations) / static_cast<double>(iterations),
+                                NumberString::GetThreadCount() });
+            Result const& result = results.back();
+            std::printf("%-28s %16.1f %12zu %14.4g %12.2f\n", result.name.c_str(), result.nanosecondsPerOp,
+                        result.iterations, result.digitsPerSecond, result.allocationsPerOp);
+            std::fflush(stdout);
+            return;
+        }
+        // Aim a little past minTime, but never grow by more than ten times at once.
+        double scale = minTime * 1.4 / std::max(elapsed.count(), 1e-9);
+        iterations = std::min(maxIterations,
+                              static_cast<size_t>(static_cast<double>(iterations) * std::clamp(scale, 2.0, 10.0)));
     }
-    NumberString& operator^= (const NumberString& other) {
-        return *this = *this ^ other;
+}
+
+void BenchmarkSuite::Run() {
+    NumberString::SetThreadCount(threadCounts.front());
+    std::printf("%-28s %16s %12s %14s %12s\n", "Benchmark", "Time (ns)", "Iterations", "Digits/s", "Allocs/op");
+    std::printf("%s\n", std::string(86, '-').c_str());
+
+    for (size_t digits = 10; digits <= maxDigits; digits *= 10) {
+        std::string text = RandomDigits(digits);
+        NumberString first{ text.c_str() }, second{ RandomDigits(digits).c_str() }, sum = first;
+        NumberString dividend{ RandomDigits(2 * digits).c_str() };
+        NumberString base{ RandomDigits(std::max<size_t>(digits / 16, 1)).c_str() }, exponent{ 16ll };
+
+        // The factorial argument whose result has about the given number of digits.
+        long long factorialArgument = 1;
+        for (double resultDigits = 0; resultDigits < static_cast<double>(digits) - 1; ) {
+            resultDigits += std::log10(static_cast<double>(++factorialArgument));
+        }
+        NumberString factorialNumber{ factorialArgument };
+
+        Measure("Add", digits, [&] { DoNotOptimize(first + second); });
+        Measure("AddAssign", digits, [&] { DoNotOptimize(sum += second); });
+        Measure("Subtract", digits, [&] { DoNotOptimize(first - second); });
+        Measure("Multiply", digits, [&] { DoNotOptimize(first * second); });
+        Measure("MultiplyAdd", digits, [&] { DoNotOptimize(first * second + dividend); });
+        Measure("Divide", digits, [&] { DoNotOptimize(dividend / first); });
+        Measure("Modulo", digits, [&] { DoNotOptimize(dividend % first); });
+        Measure("Power", digits, [&] { DoNotOptimize(base ^ exponent); });
+        Measure("Factorial", digits, [&] { DoNotOptimize(!factorialNumber); });
+        Measure("Parse", digits, [&] { DoNotOptimize(NumberString{ text.c_str() }); });
+        Measure("Print", digits, [&] { DoNotOptimize(first.Get()); });
     }
+    RunMultiplyTiers();
+    RunAddKernels();
+    RunNumberTheory();
+    RunThreadScaling();
+    NumberString::SetThreadCount(1);
+}
 
-    bool operator== (NumberString const& other) const noexcept {
-        return this->strRepresent.length() == other.strRepresent.length()
-               && this->strRepresent == other.strRepresent;
+// Times equal-length products around each multiplication threshold with the tiers
+// on both sides of it forced in turn. A tier is forced at the top level by lowering
+// its threshold to the operand length and raising the next one above it; the
+// sub-products then fall to the tiers below with their usual thresholds.
+void BenchmarkSuite::RunMultiplyTiers() {
+    size_t* const thresholds[] = { &NumberString::KaratsubaThreshold, &NumberString::Toom3Threshold,
+                                   &NumberString::FftThreshold };
+    size_t const defaults[] = { *thresholds[0], *thresholds[1], *thresholds[2] };
+    char const* const tierNames[] = { "Multiply/Schoolbook", "Multiply/Karatsuba", "Multiply/Toom3", "Multiply/Fft" };
+    struct Crossover {
+        size_t lowerTier;
+        size_t limbCounts[5];
+    };
+    // Half, about two thirds, equal, about 1.4 times and twice each default threshold.
+    Crossover const crossovers[] = { { 0, { 16, 24, 32, 44, 64 } },
+                                     { 1, { 125, 170, 250, 350, 500 } },
+                                     { 2, { 750, 1000, 1500, 2100, 3000 } } };
+
+    for (Crossover const& crossover : crossovers) {
+        for (size_t limbCount : crossover.limbCounts) {
+            size_t digits = limbCount * NumberString::BaseDigits;
+            if (digits > maxDigits) {
+                continue;
+            }
+            NumberString first{ RandomDigits(digits).c_str() }, second{ RandomDigits(digits).c_str() };
+            for (size_t tier = crossover.lowerTier; tier <= crossover.lowerTier + 1; ++tier) {
+                for (size_t i = 0; i < std::size(thresholds); ++i) {
+                    *thresholds[i] = (i < tier) ? std::min(defaults[i], limbCount)
+                                                : std::max(defaults[i], limbCount + 1);
+                }
+                Measure(tierNames[tier], digits, [&] { DoNotOptimize(first * second); });
+            }
+        }
+    }
+    for (size_t i = 0; i < std::size(thresholds); ++i) {
+        *thresholds[i] = defaults[i];
     }
+}
 
-    bool operator!= (NumberString const& other) const noexcept {
-        return !(*this == other);
+// Times addition and subtraction with the vector kernel picked for this CPU and
+// with the scalar loops, named <operation>/Simd/<digits> and <operation>/Scalar/<digits>.
+// Sizes start at 100 digits, below which values stay inline and no kernel runs.
+void BenchmarkSuite::RunAddKernels() {
+    bool const useSimdKernels = NumberString::UseSimdKernels;
+    for (size_t digits = 100; digits <= maxDigits; digits *= 10) {
+        NumberString first{ RandomDigits(digits).c_str() }, second{ RandomDigits(digits).c_str() };
+        for (bool simd : { true, false }) {
+            NumberString::UseSimdKernels = simd;
+            std::string kernel = simd ? "/Simd" : "/Scalar";
+            Measure("Add" + kernel, digits, [&] { DoNotOptimize(first + second); });
+            Measure("Subtract" + kernel, digits, [&] { DoNotOptimize(first - second); });
+        }
     }
+    NumberString::UseSimdKernels = useSimdKernels;
+}
 
+// Times Gcd, ISqrt and ModInverse around HalfGcdThreshold next to the naive
+// compositions of the basic operators they replace: Gcd against Lehmer's
+// algorithm alone (Gcd/Lehmer) and against Euclid's % loop (Gcd/Euclid), ISqrt
+// against Newton's iteration from a power of ten above the root (ISqrt/Newton).
+void BenchmarkSuite::RunNumberTheory() {
+    size_t const halfGcdThreshold = NumberString::HalfGcdThreshold;
+    for (size_t limbCount : { halfGcdThreshold / 4, halfGcdThreshold / 2, halfGcdThreshold,
+                              2 * halfGcdThreshold, 4 * halfGcdThreshold }) {
+        size_t digits = limbCount * NumberString::BaseDigits;
+        if (digits > maxDigits) {
+            continue;
+        }
+        NumberString first{ RandomDigits(digits).c_str() }, second{ RandomDigits(digits).c_str() };
+        NumberString square{ RandomDigits(2 * digits).c_str() };
+        NumberString overestimate{ ("1" + std::string((2 * digits + 1) / 2, '0')).c_str() };
+        while (Gcd(first, second) != 1ll) {
+            first += 1ll;
+        }
 
-    bool operator> (NumberString const& other) const noexcept {
-        return (this->strRepresent.length() > other.strRepresent.length())
-            || this->strRepresent.length() >= other.strRepresent.length()
-            && this->strRepresent > other.strRepresent;
+        Measure("Gcd", digits, [&] { DoNotOptimize(Gcd(first, second)); });
+        NumberString::HalfGcdThreshold = SIZE_MAX;
+        Measure("Gcd/Lehmer", digits, [&] { DoNotOptimize(Gcd(first, second)); });
+        NumberString::HalfGcdThreshold = halfGcdThreshold;
+        Measure("Gcd/Euclid", digits, [&] {
+            NumberString larger = first, smaller = second;
+            while (smaller != 0ll) {
+                larger = larger % smaller;
+                std::swap(larger, smaller);
+            }
+            DoNotOptimize(larger);
+        });
+        Measure("ModInverse", digits, [&] { DoNotOptimize(ModInverse(first, second)); });
+        Measure("ISqrt", digits, [&] { DoNotOptimize(ISqrt(square)); });
+        Measure("ISqrt/Newton", digits, [&] {
+            NumberString root = overestimate;
+            for (NumberString next = (root + square / root) / 2ll; next < root; next = (root + square / root) / 2ll) {
+                root = std::move(next);
+            }
+            DoNotOptimize(root);
+        });
     }
+}
 
-    bool operator< (NumberString const& other) const noexcept {
-        return !(*this > other || *this == other);
+// Times the operations that split work across the thread pool with every
+// requested thread count, from the smallest power of ten at which operands reach
+// ParallelThreshold limbs. Results are named <operation>/threads:<n>/<digits>.
+void BenchmarkSuite::RunThreadScaling() {
+    if (threadCounts.size() < 2) {
+        return;
     }
-
-    bool operator>= (NumberString const& other) const noexcept {
-        return (*this > other || *this == other);
+    for (size_t digits = 10; digits <= maxDigits; digits *= 10) {
+        if (digits < NumberString::ParallelThreshold * NumberString::BaseDigits) {
+            continue;
+        }
+        std::string text = RandomDigits(digits);
+        NumberString first{ text.c_str() }, second{ RandomDigits(digits).c_str() };
+        for (size_t threadCount : threadCounts) {
+            NumberString::SetThreadCount(threadCount);
+            std::string suffix = "/threads:" + std::to_string(threadCount);
+            Measure("Multiply" + suffix, digits, [&] { DoNotOptimize(first * second); });
+            Measure("Parse" + suffix, digits, [&] { DoNotOptimize(NumberString{ text.c_str() }); });
+            Measure("Print" + suffix, digits, [&] { DoNotOptimize(first.Get()); });
+        }
     }
+    NumberString::SetThreadCount(threadCounts.front());
+}
 
-    bool operator<= (NumberString const& other) const noexcept {
-        return (*this < other || *this == other);
+void BenchmarkSuite::WriteJson(std::ostream& out) const {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"simd_kernels\": " << (NumberString::UseSimdKernels ? "true" : "false") << ",\n"
+        << "    \"max_digits\": " << maxDigits << ",\n"
+        << "    \"min_time\": " << minTime << "\n  },\n"
+        << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        Result const& result = results[i];
+        out << (i ? ",\n" : "\n") << "    {\n"
+            << "      \"name\": \"" << result.name << "\",\n"
+            << "      \"digits\": " << result.digits << ",\n"
+            << "      \"threads\": " << result.threads << ",\n"
+            << "      \"iterations\": " << result.iterations << ",\n"
+            << "      \"real_time\": " << result.nanosecondsPerOp << ",\n"
+            << "      \"time_unit\": \"ns\",\n"
+            << "      \"digits_per_second\": " << result.digitsPerSecond << ",\n"
+            << "      \"allocs_per_op\": " << result.allocationsPerOp << "\n    }";
     }
+    out << "\n  ]\n}\n";
+}
 
-private:
-    void AddLeadingZeros(size_t neededLength) noexcept {
-        if (strRepresent.size() < neededLength) {
-            strRepresent =
-                    std::string(neededLength - strRepresent.length(), '0') + strRepresent;
+// BigInt --bench [--json <file>] [--max-digits <n>] [--min-time <seconds>]
+//                [--threads <n>[,<n>...]] [--filter <substring>]
+int RunBenchmarks(int argc, char** argv) {
+    size_t maxDigits = 1'000'000;
+    std::vector<size_t> threadCounts{ 1 };
+    double minTime = 0.2;
+    std::string jsonFile, filter;
+    for (int i = 0; i < argc; ++i) {
+        std::string_view option{ argv[i] };
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return 1;
+        }
+        if (option == "--json") jsonFile = argv[++i];
+        else if (option == "--max-digits") maxDigits = std::stoul(argv[++i]);
+        else if (option == "--min-time") minTime = std::stod(argv[++i]);
+        else if (option == "--threads") {
+            threadCounts.clear();
+            for (std::string_view list{ argv[++i] }; ; ) {
+                size_t comma = list.find(',');
+                threadCounts.push_back(std::stoul(std::string{ list.substr(0, comma) }));
+                if (comma == std::string_view::npos) break;
+                list.remove_prefix(comma + 1);
+            }
+        }
+        else if (option == "--filter") filter = argv[++i];
+        else {
+            std::cerr << "Unknown benchmark option " << option << std::endl;
+            return 1;
         }
     }
 
-    void RemoveTrailingZeros() {
-        size_t trailingZerosEntryIndex = strRepresent.find_first_not_of('0');
-        if (trailingZerosEntryIndex != std::string::npos) {
-            strRepresent = strRepresent.substr(trailingZerosEntryIndex);
+    std::ofstream file;
+    if (!jsonFile.empty()) {
+        file.open(jsonFile, std::ios_base::out | std::ios_base::trunc);
+        if (!file.is_open()) {
+            throw std::system_error(errno, std::generic_category(), "failed to open " + jsonFile);
         }
-        if (IsZero()) strRepresent.erase(1);
     }
 
-    [[nodiscard]] bool IsZero() const noexcept {
-        return (strRepresent == std::string(strRepresent.length(), '0'));
+    BenchmarkSuite suite(maxDigits, minTime, filter, std::move(threadCounts));
+    suite.Run();
+    if (file.is_open()) {
+        suite.WriteJson(file);
     }
+    return 0;
+}
 
-private:
-    std::string strRepresent;
-    bool isNegative;
-};
 
+// End-to-end throughput check of the BigFloat engine: pi to the given number of
+// digits, optionally with the thread pool enabled.
+void BenchmarkPi(size_t digits, size_t threadCount) {
+    NumberString::SetThreadCount(threadCount);
+    auto start = std::chrono::steady_clock::now();
+    std::string pi = BigFloat::Pi(digits).Get();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-NumberString operator+ (NumberString firstNum, NumberString secondNum) {
-    unsigned char carriableTen = 0;
-    size_t maxLength = std::max(firstNum.strRepresent.size(), secondNum.strRepresent.size());
-    auto result = NumberString{ std::string(maxLength + 1, '0').c_str() };
+    std::cout << "pi to " << digits << " digits on " << NumberString::GetThreadCount() << " thread(s): "
+              << elapsed.count() << " s, " << static_cast<double>(digits) / elapsed.count() << " digits/s, ends in "
+              << pi.substr(pi.size() - std::min<size_t>(pi.size(), 10)) << std::endl;
+    NumberString::SetThreadCount(1);
+}
 
-    bool isNegative = false;
-    if (!firstNum.isNegative && secondNum.isNegative) {
-        secondNum.isNegative = false;
-        return firstNum - secondNum;
-    }
-    else if (firstNum.isNegative && !secondNum.isNegative) {
-        firstNum.isNegative = false;
-        return secondNum - firstNum;
-    }
-    else if (firstNum.isNegative && secondNum.isNegative) {
-        isNegative = true;
-        firstNum.isNegative = secondNum.isNegative = false;
-    }
-    result.isNegative = isNegative;
 
-    firstNum.AddLeadingZeros(maxLength); secondNum.AddLeadingZeros(maxLength);
+// Behaviour checks run by BigInt --test. Every failed check is reported, and the
+// exit status is nonzero if any failed.
+size_t failedChecks = 0;
 
-    std::transform(firstNum.strRepresent.rbegin(), firstNum.strRepresent.rend(),
-                   secondNum.strRepresent.rbegin(), result.strRepresent.rbegin(),
+void Check(bool condition, char const* description) {
+    if (!condition) {
+        std::cerr << "FAILED: " << description << std::endl;
+        ++failedChecks;
+    }
+}
 
-                   [&carriableTen](char x, char y) noexcept -> char {
-                       char cDigit = (x - '0') + (y - '0') + carriableTen;
-                       if (cDigit > 9) { carriableTen = 1; cDigit -= 10; }
-                       else { carriableTen = 0; }
-                       return cDigit + '0';
-                   });
-    result.strRepresent.front() = carriableTen + '0';
+// Fills freshly freed arena memory with other digits, so a NumberString that still
+// points into it reads garbage even without AddressSanitizer.
+void ReuseFreedArenaMemory() {
+    ComputationArena arena;
+    std::vector<NumberString> filler;
+    for (int i = 0; i < 64; ++i) {
+        filler.push_back(NumberString{ "999999999999999999999999999999999999999999999999" } * (i + 2));
+    }
+}
 
-    result.RemoveTrailingZeros();
-    return result;
+NumberString SquareInArena(NumberString const& factor) {
+    ComputationArena arena;
+    NumberString square = factor * factor;
+    return square;
 }
 
-NumberString operator- (NumberString firstNum, NumberString secondNum) {
-    unsigned char carriableTen = 0;
-    size_t maxLength = std::max(firstNum.strRepresent.size(), secondNum.strRepresent.size());
-    auto result = NumberString{ std::string(maxLength + 1, '0').c_str() };
+void TestArenaEscape() {
+    NumberString factor{ "123456789012345678901234567890123456789012345678901234567890" };
+    NumberString expected = factor * factor;
 
-    if (secondNum.isNegative) {
-        secondNum.isNegative = false;
-        return firstNum + secondNum;
+    NumberString assigned;
+    {
+        ComputationArena arena;
+        assigned = factor * factor;
     }
-    else if (firstNum.isNegative) {
-        secondNum.isNegative = true;
-        return firstNum + secondNum;
+    ReuseFreedArenaMemory();
+    Check(assigned == expected, "value assigned inside an arena scope survives the scope");
+
+    NumberString grown{ 1ll };
+    {
+        ComputationArena arena;
+        grown *= factor;
+        grown *= factor;
     }
-
-    bool IsNegative = false;
-    if (firstNum < secondNum) {
-        IsNegative = true;
-        std::swap(firstNum, secondNum);
-        firstNum.isNegative = false;
+    ReuseFreedArenaMemory();
+    Check(grown == expected, "value grown in place inside an arena scope survives the scope");
+
+    NumberString outer;
+    {
+        ComputationArena outerArena;
+        NumberString inner;
+        {
+            ComputationArena innerArena;
+            inner = factor * factor;
+            outer = inner;
+        }
+        ReuseFreedArenaMemory();
+        Check(inner == expected, "value assigned inside a nested arena survives the nested scope");
     }
+    ReuseFreedArenaMemory();
+    Check(outer == expected, "value copied inside nested arenas survives both scopes");
+
+    NumberString persisted;
+    {
+        ComputationArena arena;
+        NumberString local = factor * factor;
+        persisted = ComputationArena::Persist(local);
+    }
+    ReuseFreedArenaMemory();
+    Check(persisted == expected, "Persist copies a value out of an arena");
+
+    std::vector<NumberString> pushed, emplaced;
+    std::pair<NumberString, Divisor> member{ NumberString{}, Divisor{ NumberString{ 7ll } } };
+    {
+        ComputationArena arena;
+        pushed.push_back(factor * factor);
+        emplaced.emplace_back(factor * factor);
+        emplaced.emplace_back(1ll);
+        emplaced.back() *= factor;
+        emplaced.back() *= factor;
+        member.first = factor * factor;
+        member.second = Divisor{ factor * factor };
+    }
+    NumberString returned = SquareInArena(factor);
+    ReuseFreedArenaMemory();
+    Check(pushed[0] == expected, "value pushed into an outer vector inside an arena scope survives the scope");
+    Check(emplaced[0] == expected, "value emplaced into an outer vector inside an arena scope survives the scope");
+    Check(emplaced[1] == expected, "element created and grown inside an arena scope survives the scope");
+    Check(member.first == expected, "member of an outer object assigned inside an arena scope survives the scope");
+    Check(expected % member.second == NumberString{ 0ll } && (expected + 5ll) % member.second == NumberString{ 5ll },
+          "Divisor built inside an arena scope survives the scope");
+    Check(returned == expected, "value returned from a function that opens an arena survives the arena");
+}
 
-    firstNum.AddLeadingZeros(maxLength); secondNum.AddLeadingZeros(maxLength);
-
-    std::transform(firstNum.strRepresent.rbegin(), firstNum.strRepresent.rend(),
-                   secondNum.strRepresent.rbegin(), result.strRepresent.rbegin(),
-
-                   [&carriableTen](char x, char y) noexcept -> char {
-                       char cDigit = (x - '0') - (y - '0') - carriableTen;
-                       if (cDigit < 0) { carriableTen = 1; cDigit += 10; }
-                       else { carriableTen = 0; }
-                       return cDigit + '0';
-                   });
+// The documented example mixes a lazy sum with the NumberString rvalue c * d; it
+// must resolve to the lazy operators without any ambiguity.
+void TestLazyExpressions() {
+    NumberString a{ "123456789012345678901234567890" }, b{ "987654321" }, c{ "5555555555555555" }, d{ -777ll };
+    static_assert(LazyExpression<decltype(Lazy(a) + b - c * d)>);
+    static_assert(LazyExpression<decltype(c * d + Lazy(a))>);
+
+    NumberString fused = Lazy(a) + b - c * d;
+    Check(fused == NumberString{ "123456789016662345568888888446" }, "Lazy(a) + b - c * d");
+    NumberString reversed = c * d + Lazy(a) - NumberString{ b };
+    Check(reversed == NumberString{ "123456789008029012233580247334" }, "c * d + Lazy(a) - rvalue");
+    NumberString accumulator{ 1ll };
+    accumulator += Lazy(a) * c;
+    Check(accumulator == NumberString{ "685871050068587036419753703641289499314128951" }, "acc += Lazy(a) * c");
+}
 
-    result.RemoveTrailingZeros();
-    result.isNegative = IsNegative;
-    return result;
+NumberString Magnitude(NumberString const& value) {
+    return (value < 0ll) ? value * -1ll : value;
 }
 
-NumberString operator* (NumberString firstNum, NumberString secondNum) {
-    unsigned char carry = 0;
-    size_t thisSize = firstNum.strRepresent.size();
-    size_t otherSize = secondNum.strRepresent.size();
-    std::string resultString(thisSize + otherSize, 0);
-
-    for (int i = firstNum.strRepresent.size() - 1; i >= 0; --i) {
-        for (int j = secondNum.strRepresent.size() - 1; j >= 0; --j) {
-            char n = (firstNum.strRepresent[i] - '0') * (secondNum.strRepresent[j] - '0') +
-                     resultString[i + j + 1];
-            resultString.at(i + j) += n / 10;
-            resultString.at(i + j + 1) = n % 10;
-        }
+// The reference Gcd: Euclid's algorithm on the magnitudes with nothing but %.
+NumberString EuclidGcd(NumberString first, NumberString second) {
+    first = Magnitude(first);
+    second = Magnitude(second);
+    while (second != 0ll) {
+        first = first % second;
+        std::swap(first, second);
     }
-    std::transform(resultString.begin(), resultString.end(), resultString.begin(),
-                   [](char sym) { return sym + '0'; });
+    return first;
+}
 
-    auto result = NumberString{ resultString.c_str() };
-    result.isNegative = firstNum.isNegative != secondNum.isNegative;
-    result.RemoveTrailingZeros();
-    return result;
+NumberString RandomNumber(std::mt19937_64& generator, size_t digits) {
+    std::string text(digits, '0');
+    for (char& digit : text) {
+        digit = static_cast<char>('0' + generator() % 10);
+    }
+    text.front() = static_cast<char>('1' + generator() % 9);
+    return NumberString{ text.c_str() };
 }
 
-NumberString operator/ (NumberString firstNum, NumberString secondNum) {
-    if (secondNum.IsZero()) {
-        throw std::overflow_error("Division by zero exception");
+// Operands of up to about 60 limbs with HalfGcdThreshold lowered to a few limbs,
+// so Gcd and ExtendedGcd recurse through several levels of half-GCD matrices and
+// take the row negations and swaps for steps that overshoot.
+void TestNumberTheory() {
+    size_t const halfGcdThreshold = NumberString::HalfGcdThreshold;
+    NumberString::HalfGcdThreshold = 8;
+
+    NumberString powerOfTwo = NumberString{ 2ll } ^ NumberString{ 1600ll };
+    NumberString powerOfThree = NumberString{ 3ll } ^ NumberString{ 1000ll };
+    NumberString common = (NumberString{ 7ll } ^ NumberString{ 150ll }) + 6ll;
+    NumberString first = powerOfTwo * common, second = powerOfThree * common;
+    Check(Gcd(first, second) == common, "Gcd of coprime multiples of a common factor");
+    Check(Gcd(first + 1ll, second + 1ll) == EuclidGcd(first + 1ll, second + 1ll), "Gcd matches Euclid's algorithm");
+    Check(Gcd(first * common, second) == EuclidGcd(first * common, second), "Gcd of unbalanced operands");
+    Check(Gcd(first, 0ll) == first && Gcd(0ll, second) == second, "Gcd with zero");
+
+    bool isBezoutHeld = true, isGcdPositive = true;
+    for (long long firstSign : { 1ll, -1ll }) {
+        for (long long secondSign : { 1ll, -1ll }) {
+            for (NumberString const& other : { second, second + 1ll, NumberString{ 0ll } }) {
+                NumberString signedFirst = first * firstSign, signedSecond = other * secondSign;
+                auto [divisor, firstFactor, secondFactor] = ExtendedGcd(signedFirst, signedSecond);
+                isBezoutHeld = isBezoutHeld && signedFirst * firstFactor + signedSecond * secondFactor == divisor;
+                isGcdPositive = isGcdPositive && divisor == EuclidGcd(signedFirst, signedSecond);
+            }
+        }
+    }
+    std::mt19937_64 generator{ 7 };
+    for (size_t threshold : { 2, 8 }) {
+        NumberString::HalfGcdThreshold = threshold;
+        for (int i = 0; i < 60; ++i) {
+            NumberString factor = RandomNumber(generator, 1 + generator() % 40);
+            NumberString signedFirst = RandomNumber(generator, 200 + generator() % 250) * factor;
+            NumberString signedSecond = RandomNumber(generator, 200 + generator() % 250) * factor;
+            if (i % 3 == 1) signedFirst = signedFirst * -1ll;
+            if (i % 4 == 2) signedSecond = signedSecond * -1ll;
+            auto [divisor, firstFactor, secondFactor] = ExtendedGcd(signedFirst, signedSecond);
+            isBezoutHeld = isBezoutHeld && signedFirst * firstFactor + signedSecond * secondFactor == divisor;
+            isGcdPositive = isGcdPositive && divisor == EuclidGcd(signedFirst, signedSecond)
+                            && Gcd(signedFirst, signedSecond) == divisor;
+        }
+    }
+    NumberString::HalfGcdThreshold = 8;
+    Check(isBezoutHeld, "ExtendedGcd satisfies a * x + b * y == g for every sign combination");
+    Check(isGcdPositive, "Gcd and ExtendedGcd return the positive gcd for every sign combination");
+
+    NumberString inverse = ModInverse(powerOfTwo, powerOfThree);
+    Check(inverse >= 0ll && inverse < powerOfThree && powerOfTwo * inverse % powerOfThree == 1ll, "ModInverse");
+    NumberString negativeInverse = ModInverse(powerOfTwo * -1ll, powerOfThree);
+    Check((negativeInverse + inverse) % powerOfThree == 0ll, "ModInverse of a negative number");
+    bool isThrown = false;
+    try {
+        static_cast<void>(ModInverse(first, second));
     }
-    if (firstNum == secondNum) {
-        return NumberString{ 1 };
+    catch (std::domain_error const&) {
+        isThrown = true;
     }
-    if (secondNum > firstNum) {
-        return NumberString{};
+    Check(isThrown, "ModInverse throws domain_error when the operands are not coprime");
+    NumberString::HalfGcdThreshold = halfGcdThreshold;
+
+    bool isRootBounded = true;
+    for (unsigned degree : { 2u, 3u, 5u, 17u }) {
+        for (NumberString const& radicand : { first, second + 12345ll, NumberString{ 1ll }, NumberString{ 80ll } }) {
+            NumberString root = IRoot(radicand, degree), power{ static_cast<long long>(degree) };
+            isRootBounded = isRootBounded && (root ^ power) <= radicand && radicand < ((root + 1ll) ^ power);
+        }
     }
+    Check(isRootBounded, "IRoot returns r with r^k <= n < (r + 1)^k");
+    NumberString cube = common ^ NumberString{ 3ll };
+    Check(IRoot(cube, 3) == common && IRoot(cube - 1ll, 3) == common - 1ll,
+          "IRoot of a perfect power and its predecessor");
+    Check(IRoot(cube * -1ll, 3) == common * -1ll, "IRoot of a negative number with an odd degree");
+    Check(ISqrt(powerOfTwo) == (NumberString{ 2ll } ^ NumberString{ 800ll }) && ISqrt(0ll) == 0ll, "ISqrt");
+}
 
-    NumberString quotient;
-    quotient.isNegative = firstNum.isNegative != secondNum.isNegative;
-    firstNum.isNegative = secondNum.isNegative = false;
-    size_t dividendLength = firstNum.strRepresent.length(), divisorLength = secondNum.strRepresent.length();
-    size_t quotientLength = dividendLength - divisorLength + 1;
+// Multiplies with Toom3Threshold and FftThreshold lowered to 16 limbs, so every
+// product of at least that length goes through the three-prime NTT, and compares
+// with the Karatsuba and schoolbook products of the default thresholds.
+void TestFftMultiply() {
+    std::mt19937_64 generator{ 13 };
+    NumberString nines = (NumberString{ 10ll } ^ NumberString{ 576ll }) - 1ll;
+    std::vector<std::pair<NumberString, NumberString>> operands{
+        { RandomNumber(generator, 333), RandomNumber(generator, 549) },
+        { RandomNumber(generator, 900), RandomNumber(generator, 1400) },
+        { RandomNumber(generator, 150), RandomNumber(generator, 1800) },
+        // 64 limbs of B - 1 each: the product fills the transform length exactly
+        // and its convolution terms reach their largest possible value.
+        { nines, nines * -1ll },
+        { nines, nines - 12345ll },
+    };
+    NumberString square = RandomNumber(generator, 1350);
+    std::vector<NumberString> expected;
+    for (auto const& [first, second] : operands) {
+        expected.push_back(first * second);
+    }
+    NumberString expectedSquare = square * square, expectedNinesSquare = nines * nines;
 
-    quotient.strRepresent.resize(quotientLength);
-    auto remain = NumberString{ firstNum.strRepresent.substr(0, divisorLength).c_str() };
+    size_t const toom3Threshold = NumberString::Toom3Threshold, fftThreshold = NumberString::FftThreshold;
+    NumberString::Toom3Threshold = NumberString::FftThreshold = 16;
+    bool isProductEqual = true;
+    for (size_t i = 0; i < operands.size(); ++i) {
+        isProductEqual = isProductEqual && operands[i].first * operands[i].second == expected[i];
+    }
+    Check(isProductEqual, "NTT products of unequal and unbalanced operands match Karatsuba");
+    Check(square * square == expectedSquare && nines * nines == expectedNinesSquare,
+          "NTT squaring matches Karatsuba");
+    Check(square * NumberString{ square } == expectedSquare, "NTT product of two equal operands matches Karatsuba");
+    NumberString::Toom3Threshold = toom3Threshold;
+    NumberString::FftThreshold = fftThreshold;
+}
 
-    for (int i = 0, entriesCount = 0; i < quotientLength; entriesCount = 0) {
-        while (remain >= secondNum) {
-            remain -= secondNum;
-            ++entriesCount;
-        }
-        quotient.strRepresent[i] = static_cast<unsigned char>(entriesCount) + '0';
+// Whether quotient and remainder are the truncating division of dividend by
+// divisor: q * d + r == n, |r| < |d|, r has the sign of n and q is the quotient
+// of the magnitudes with the sign of the product.
+bool IsTruncatingDivision(NumberString const& dividend, NumberString const& divisor,
+                          std::pair<NumberString, NumberString> const& result) {
+    auto const& [quotient, remainder] = result;
+    bool isQuotientNegative = (dividend < 0ll) != (divisor < 0ll);
+    return quotient * divisor + remainder == dividend && Magnitude(remainder) < Magnitude(divisor)
+           && (remainder == 0ll || (remainder < 0ll) == (dividend < 0ll))
+           && (quotient == 0ll || (quotient < 0ll) == isQuotientNegative);
+}
 
-        if (remain.strRepresent == NumberString{}.strRepresent) {
-            remain.strRepresent.clear();
-            while (i < quotientLength && firstNum.strRepresent[divisorLength + i] == '0') {
-                quotient.strRepresent[++i] = '0';
+// Runs each division path on the same operands: Knuth's Algorithm D with the
+// default thresholds, then Newton reciprocals and Barrett reduction with
+// NewtonDivisionThreshold and Divisor::BarrettThreshold lowered to 3 limbs.
+void TestDivision() {
+    size_t const newtonDivisionThreshold = NumberString::NewtonDivisionThreshold;
+    size_t const barrettThreshold = Divisor::BarrettThreshold;
+
+    std::mt19937_64 generator{ 11 };
+    std::vector<std::pair<NumberString, NumberString>> operands;
+    for (int i = 0; i < 40; ++i) {
+        NumberString divisor = RandomNumber(generator, 2 + generator() % 120);
+        operands.emplace_back(RandomNumber(generator, 1 + generator() % 400), divisor);
+        operands.emplace_back(divisor * RandomNumber(generator, 1 + generator() % 200), divisor);
+    }
+    // Random operands almost never reach the rare corrections. Limbs (B/2, 0, 0, 0, 1)
+    // make the two-limb estimate of Algorithm D one too large, so it needs its
+    // add-back step. B^2 + 1 leaves the Barrett estimate for the six limbs
+    // (B-1, B-1, B-1, B-3, B-1, B-1) two short, so it needs both corrections.
+    operands.emplace_back(NumberString{ "1000000000000000000000000000000000000000000000" },
+                          NumberString{ "500000000000000000000000000000000000000000001" });
+    operands.emplace_back(NumberString{ "999999999999999999999999999999999997999999999999999999" },
+                          NumberString{ "1000000000000000001" });
+    for (long long smallDivisor : { 1ll, 2ll, 7ll, 1000000ll, 999999999ll }) {
+        operands.emplace_back(RandomNumber(generator, 300), NumberString{ smallDivisor });
+    }
+
+    for (int pass = 0; pass < 2; ++pass) {
+        NumberString::NewtonDivisionThreshold = pass ? 3 : newtonDivisionThreshold;
+        Divisor::BarrettThreshold = pass ? 3 : barrettThreshold;
+        bool isTruncating = true, isDivisorConsistent = true;
+        for (auto const& [dividend, divisor] : operands) {
+            for (long long dividendSign : { 1ll, -1ll }) {
+                for (long long divisorSign : { 1ll, -1ll }) {
+                    NumberString signedDividend = dividend * dividendSign, signedDivisor = divisor * divisorSign;
+                    std::pair<NumberString, NumberString> result = DivMod(signedDividend, signedDivisor);
+                    isTruncating = isTruncating && IsTruncatingDivision(signedDividend, signedDivisor, result)
+                                   && signedDividend / signedDivisor == result.first
+                                   && signedDividend % signedDivisor == result.second;
+                    Divisor cached{ signedDivisor };
+                    isDivisorConsistent = isDivisorConsistent && DivMod(signedDividend, cached) == result
+                                          && signedDividend / cached == result.first
+                                          && signedDividend % cached == result.second;
+                }
             }
         }
-        while (i < quotientLength
-               && (remain.strRepresent.length() < secondNum.strRepresent.length()
-                   || remain.strRepresent < secondNum.strRepresent
-                      && (remain.strRepresent.length() == secondNum.strRepresent.length()))) {
-            remain.strRepresent.resize(remain.strRepresent.size() + 1);
-            remain.strRepresent.back() = firstNum.strRepresent[divisorLength + i];
-            quotient.strRepresent[++i] = '0';
-        }
+        Check(isTruncating, pass ? "Newton division truncates with q * d + r == n and |r| < |d|"
+                                 : "Knuth division truncates with q * d + r == n and |r| < |d|");
+        Check(isDivisorConsistent, pass ? "Divisor with Barrett reduction matches DivMod"
+                                        : "Divisor with Knuth division matches DivMod");
     }
-
-    quotient.RemoveTrailingZeros();
-    return quotient;
+    NumberString::NewtonDivisionThreshold = newtonDivisionThreshold;
+    Divisor::BarrettThreshold = barrettThreshold;
+
+    NumberString big = RandomNumber(generator, 100);
+    Check(DivMod(big, big * 3ll) == std::pair{ NumberString{ 0ll }, big }, "dividend smaller than the divisor");
+    Check(DivMod(big * -3ll, big) == std::pair{ NumberString{ -3ll }, NumberString{ 0ll } }, "exact negative quotient");
+    bool isThrown = false;
+    try {
+        static_cast<void>(DivMod(big, NumberString{ 0ll }));
+    }
+    catch (std::overflow_error const&) {
+        isThrown = true;
+    }
+    Check(isThrown, "DivMod throws overflow_error for a zero divisor");
 }
 
-NumberString operator% (const NumberString& firstNum, const NumberString& secondNum) {
-    if (secondNum.IsZero()) {
-        throw std::overflow_error("Division by zero exception");
+// Rounds exact ties, and results whose discarded digits only the sticky digit
+// tells apart from a tie, in every RoundingMode. The expected values are from
+// Python's decimal module, the digits of Pi and e from Machin's formula and the
+// series of e summed in Python integers.
+void TestBigFloatRounding() {
+    using enum RoundingMode;
+    RoundingMode const modes[] = {
+        HalfEven, HalfAwayFromZero, TowardZero, AwayFromZero, TowardPositive, TowardNegative
+    };
+    struct RoundingCase {
+        char const* description;
+        BigFloat (*compute)(RoundingMode);
+        char const* expected[std::size(modes)];
+    };
+    RoundingCase const cases[] = {
+        { "2.5 rounded to one digit", [](RoundingMode mode) { return BigFloat{ "2.5", 1, mode }; },
+          { "2", "3", "2", "3", "3", "2" } },
+        { "3.5 rounded to one digit", [](RoundingMode mode) { return BigFloat{ "3.5", 1, mode }; },
+          { "4", "4", "3", "4", "4", "3" } },
+        { "-2.5 rounded to one digit", [](RoundingMode mode) { return BigFloat{ "-2.5", 1, mode }; },
+          { "-2", "-3", "-2", "-3", "-2", "-3" } },
+        { "-3.5 rounded to one digit", [](RoundingMode mode) { return BigFloat{ "-3.5", 1, mode }; },
+          { "-4", "-4", "-3", "-4", "-3", "-4" } },
+        { "sticky limb below a tie",
+          [](RoundingMode mode) { return BigFloat{ "2.5000000000000000000000001", 1, mode }; },
+          { "3", "3", "2", "3", "3", "2" } },
+        { "sticky limbs below a whole-limb tie",
+          [](RoundingMode mode) { return BigFloat{ "-2.500000000000000000000000001", 1, mode }; },
+          { "-3", "-3", "-2", "-3", "-2", "-3" } },
+        { "sticky limb below a zero digit",
+          [](RoundingMode mode) { return BigFloat{ "2.0000000000000000000000001", 1, mode }; },
+          { "2", "2", "2", "3", "3", "2" } },
+        { "exact tie 1 / 8 to two digits",
+          [](RoundingMode mode) { return BigFloat{ "1", 2, mode } / BigFloat{ "8", 2 }; },
+          { "0.12", "0.13", "0.12", "0.13", "0.13", "0.12" } },
+        { "sticky digit of 86 / 91 = 0.94505...",
+          [](RoundingMode mode) { return BigFloat{ "86", 2, mode } / BigFloat{ "91", 2 }; },
+          { "0.95", "0.95", "0.94", "0.95", "0.95", "0.94" } },
+        { "sticky digit of -86 / 91",
+          [](RoundingMode mode) { return BigFloat{ "-86", 2, mode } / BigFloat{ "91", 2 }; },
+          { "-0.95", "-0.95", "-0.94", "-0.95", "-0.94", "-0.95" } },
+        { "sticky digit of Sqrt(82) = 9.0553...", [](RoundingMode mode) { return Sqrt(BigFloat{ "82", 2, mode }); },
+          { "9.1", "9.1", "9.0", "9.1", "9.1", "9.0" } },
+        { "sticky digit of 1 - 1e-30",
+          [](RoundingMode mode) { return BigFloat{ "1", 2, mode } - BigFloat{ "1e-30", 2 }; },
+          { "1.0", "1.0", "0.99", "1.0", "1.0", "0.99" } },
+        { "sticky digit of -1 - 1e-30",
+          [](RoundingMode mode) { return BigFloat{ "-1", 2, mode } - BigFloat{ "1e-30", 2 }; },
+          { "-1.0", "-1.0", "-1.0", "-1.1", "-1.0", "-1.1" } },
+    };
+    for (RoundingCase const& roundingCase : cases) {
+        bool isRounded = true;
+        for (size_t i = 0; i < std::size(modes); ++i) {
+            isRounded = isRounded && roundingCase.compute(modes[i]) == BigFloat{ roundingCase.expected[i] };
+        }
+        Check(isRounded, roundingCase.description);
     }
-    return NumberString{ firstNum - (firstNum / secondNum) * secondNum };
-}
 
-NumberString operator^ (const NumberString& number, const NumberString& power) {
-    if (power == "0") return 1;
-    return number * (number ^ (power - 1));
+    char const* pi = "3.14159265358979323846264338327950288419716939937510"
+                     "58209749445923078164062862089986280348253421170679";
+    char const* e = "2.71828182845904523536028747135266249775724709369995"
+                    "95749669676277240766303535475945713821785251664274";
+    Check(BigFloat::Pi(100) == BigFloat{ pi, 100 }, "Pi(100) rounds the first 100 digits to nearest");
+    Check(BigFloat::Pi(100, TowardZero).Get() == std::string_view{ pi, 101 }, "Pi(100, TowardZero) truncates");
+    Check(BigFloat::E(100) == BigFloat{ e, 100 }
+          && BigFloat::E(100, TowardPositive) == BigFloat{ e, 100, AwayFromZero },
+          "E(100) rounds the first 100 digits to nearest and upward");
 }
 
-NumberString operator! (const NumberString& number) {
-    if (number == "1") return 1;
-    return number * !(number - 1);
+int RunTests() {
+    TestArenaEscape();
+    TestLazyExpressions();
+    TestNumberTheory();
+    TestDivision();
+    TestFftMultiply();
+    TestBigFloatRounding();
+
+    if (failedChecks != 0) {
+        std::cerr << failedChecks << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
 }
 
 
 int main(int argc, char** argv) {
+    if (argc > 1 && std::string_view{ argv[1] } == "--bench") {
+        try {
+            return RunBenchmarks(argc - 2, argv + 2);
+        }
+        catch (std::exception const& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+    }
+    if (argc > 1 && std::string_view{ argv[1] } == "--test") {
+        return RunTests();
+    }
+    if (argc > 2 && std::string_view{ argv[1] } == "--pi") {
+        BenchmarkPi(std::stoul(argv[2]), (argc > 3) ? std::stoul(argv[3]) : 1);
+        return 0;
+    }
 
     NumberString str{"-45723645350934253495734598345340453753498567340"
                      "5368459345890346859346953495346953465934695"
@@ -0,0 +1,4035 @@
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// A vector of trivially copyable elements that keeps up to InlineCapacity of them
+// inside the object and only goes to the heap, through a stateless Allocator,
+// once it grows past that. An Allocator with scopes (PoolAllocator) tags every
+// vector with the scope it was created in, or with the scope of the vector it was
+// copied or moved from: the vector allocates only blocks that live at least that
+// long, and a move copies a buffer it must not adopt.
+template<class T, size_t InlineCapacity, class Allocator = std::allocator<T>>
+class SmallVector final {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    static constexpr bool HasScopes = requires(T const* pointer) {
+        Allocator::Scope();
+        Allocator::IsOwnable(pointer, Allocator::Scope());
+    };
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = T const*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+public:
+    // Tag for a vector in the outermost scope, which never allocates or adopts
+    // arena blocks, whichever scope it is created in.
+    struct OutermostScope {
+        explicit OutermostScope() = default;
+    };
+
+public:
+    SmallVector() noexcept = default;
+
+    explicit SmallVector(OutermostScope) noexcept : scope(0) {}
+
+    explicit SmallVector(size_t count, T const& value = T()) {
+        assign(count, value);
+    }
+
+    template<std::forward_iterator I> SmallVector(I first, I last) {
+        assign(first, last);
+    }
+
+    SmallVector(SmallVector const& other) : scope(other.scope) {
+        assign(other.begin(), other.end());
+    }
+
+    // Only a buffer from another thread's arena is copied here, and running out of
+    // memory then terminates.
+    SmallVector(SmallVector&& other) noexcept : scope(other.scope) {
+        StealFrom(other);
+    }
+
+    ~SmallVector() {
+        Release();
+    }
+
+    SmallVector& operator= (SmallVector const& other) {
+        if (this != &other) assign(other.begin(), other.end());
+        return *this;
+    }
+
+    SmallVector& operator= (SmallVector&& other) noexcept(!HasScopes) {
+        if (this != &other) {
+            if (!other.IsInline() && CanAdopt(other.elements)) {
+                Release();
+            }
+            StealFrom(other);
+        }
+        return *this;
+    }
+
+
+    [[nodiscard]] size_t size() const noexcept { return length; }
+    [[nodiscard]] size_t capacity() const noexcept { return reserved; }
+    [[nodiscard]] bool empty() const noexcept { return length == 0; }
+    [[nodiscard]] bool IsInline() const noexcept { return elements == inlineElements; }
+
+    T* data() noexcept { return elements; }
+    T const* data() const noexcept { return elements; }
+
+    T& operator[] (size_t position) noexcept { return elements[position]; }
+    T const& operator[] (size_t position) const noexcept { return elements[position]; }
+    T& front() noexcept { return elements[0]; }
+    T const& front() const noexcept { return elements[0]; }
+    T& back() noexcept { return elements[length - 1]; }
+    T const& back() const noexcept { return elements[length - 1]; }
+
+    iterator begin() noexcept { return elements; }
+    iterator end() noexcept { return elements + length; }
+    const_iterator begin() const noexcept { return elements; }
+    const_iterator end() const noexcept { return elements + length; }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+
+    void reserve(size_t newCapacity) {
+        if (newCapacity <= reserved) {
+            return;
+        }
+        T* newElements = Allocate(newCapacity);
+        std::memcpy(newElements, elements, length * sizeof(T));
+        Release();
+        elements = newElements;
+        reserved = newCapacity;
+    }
+
+    void resize(size_t newSize, T const& value = T()) {
+        if (newSize > reserved) {
+            reserve(std::max(newSize, 2 * reserved));
+        }
+        if (newSize > length) {
+            std::fill(elements + length, elements + newSize, value);
+        }
+        length = newSize;
+    }
+
+    void clear() noexcept { length = 0; }
+
+    void push_back(T const& value) {
+        if (length == reserved) {
+            T copy = value;
+            reserve(2 * reserved);
+            elements[length++] = copy;
+        }
+        else {
+            elements[length++] = value;
+        }
+    }
+
+    void pop_back() noexcept { --length; }
+
+    void assign(size_t count, T const& value) {
+        clear();
+        resize(count, value);
+    }
+
+    template<std::forward_iterator I> void assign(I first, I last) {
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        clear();
+        reserve(count);
+        std::copy(first, last, elements);
+        length = count;
+    }
+
+    template<std::forward_iterator I> iterator insert(const_iterator position, I first, I last) {
+        size_t offset = static_cast<size_t>(position - elements);
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        if (length + count > reserved) {
+            reserve(std::max(length + count, 2 * reserved));
+        }
+        std::memmove(elements + offset + count, elements + offset, (length - offset) * sizeof(T));
+        std::copy(first, last, elements + offset);
+        length += count;
+        return elements + offset;
+    }
+
+    friend bool operator== (SmallVector const& first, SmallVector const& second) noexcept {
+        return std::equal(first.begin(), first.end(), second.begin(), second.end());
+    }
+
+private:
+    void Release() noexcept {
+        if (!IsInline()) {
+            Allocator{}.deallocate(elements, reserved);
+        }
+        elements = inlineElements;
+        reserved = InlineCapacity;
+    }
+
+    T* Allocate(size_t count) {
+        if constexpr (HasScopes) {
+            return Allocator{}.allocate(count, scope);
+        }
+        else {
+            return Allocator{}.allocate(count);
+        }
+    }
+
+    [[nodiscard]] bool CanAdopt(T const* buffer) const noexcept {
+        if constexpr (HasScopes) {
+            return Allocator::IsOwnable(buffer, scope);
+        }
+        else {
+            return true;
+        }
+    }
+
+    static uint64_t CurrentScope() noexcept {
+        if constexpr (HasScopes) {
+            return Allocator::Scope();
+        }
+        else {
+            return 0;
+        }
+    }
+
+    // Takes over the buffer of other when this vector may own it and copies the
+    // elements otherwise; a heap buffer of this vector must be released already
+    // in the first case.
+    void StealFrom(SmallVector& other) {
+        if (other.IsInline() || !CanAdopt(other.elements)) {
+            assign(other.begin(), other.end());
+        }
+        else {
+            elements = other.elements;
+            reserved = other.reserved;
+            length = other.length;
+            other.elements = other.inlineElements;
+            other.reserved = InlineCapacity;
+        }
+        other.length = 0;
+    }
+
+private:
+    T* elements = inlineElements;
+    size_t length = 0;
+    size_t reserved = InlineCapacity;
+    uint64_t scope = CurrentScope();
+    T inlineElements[InlineCapacity];
+};
+
+
+class ComputationArena;
+
+// Heap storage for NumberString limbs. Freed blocks are kept in per-thread free
+// lists of power-of-two size classes and handed out again instead of going back
+// to the system allocator. While a ComputationArena is alive on a thread, that
+// thread's allocations come from the arena instead.
+class MemoryPool final {
+public:
+    MemoryPool() = delete;
+
+    // Allocates from the innermost arena of this thread that is not newer than
+    // scope, or from the pool when there is none, so the block lives at least as
+    // long as an owner created in that scope.
+    static void* Allocate(size_t bytes, uint64_t scope);
+    static void Deallocate(void* pointer) noexcept;
+
+    // The scope of the innermost ComputationArena of this thread, 0 without one.
+    [[nodiscard]] static uint64_t CurrentScope() noexcept;
+    // Whether an owner created in scope may keep the block: pool blocks always, arena
+    // blocks only when their arena is alive on this thread and not newer than scope.
+    [[nodiscard]] static bool IsOwnable(void const* pointer, uint64_t scope) noexcept;
+
+    // Returns the blocks cached by the calling thread to the system allocator.
+    static void Trim() noexcept;
+
+private:
+    friend class ComputationArena;
+
+    // Every block starts with a header naming its size class, so a block can be
+    // freed on any thread and arena blocks are recognized without a lookup.
+    struct alignas(16) BlockHeader {
+        uint32_t sizeClass;
+        uint64_t arenaSerial;
+    };
+    static constexpr uint32_t ArenaBlock = ~0u, LargeBlock = ~0u - 1;
+    static constexpr size_t MinClassBytes = 64, ClassCount = 15, MaxCachedBlocks = 64;
+
+    struct ThreadCache {
+        std::vector<void*> freeBlocks[ClassCount];
+        ~ThreadCache() {
+            Release();
+            isCacheDestroyed = true;
+        }
+        void Release() noexcept;
+    };
+
+    // Blocks freed by destructors that run after the thread's cache is gone go
+    // straight back to the system allocator.
+    static ThreadCache* Cache() noexcept {
+        thread_local ThreadCache cache;
+        return isCacheDestroyed ? nullptr : &cache;
+    }
+
+    static inline thread_local bool isCacheDestroyed = false;
+
+    static inline thread_local ComputationArena* currentArena = nullptr;
+};
+
+
+// Scoped bump allocator for the temporaries of a computation. Every scratch limb
+// buffer allocated on this thread while the arena is alive is carved from its
+// chunks, freeing such a buffer is a no-op, and the destructor releases all of
+// them at once. The limbs of a NumberString or Divisor never live in an arena, so
+// values computed in the scope may be stored anywhere and outlive it; a result
+// moved out of a scratch buffer into a NumberString is copied to the pool.
+class ComputationArena final {
+public:
+    explicit ComputationArena(size_t chunkBytes = size_t{ 1 } << 16)
+    : nextChunkBytes(chunkBytes), serial(++arenaCount), previous(MemoryPool::currentArena) {
+        MemoryPool::currentArena = this;
+    }
+
+    ComputationArena(ComputationArena const&) = delete;
+    ComputationArena& operator= (ComputationArena const&) = delete;
+
+    ~ComputationArena() {
+        MemoryPool::currentArena = previous;
+        for (char* chunk : chunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+
+    [[nodiscard]] size_t GetReservedBytes() const noexcept {
+        return reservedBytes;
+    }
+
+    // Copies a value into storage that does not belong to any arena.
+    template<class T> [[nodiscard]] static T Persist(T const& value) {
+        ComputationArena* active = MemoryPool::currentArena;
+        MemoryPool::currentArena = nullptr;
+        try {
+            T copy(value);
+            MemoryPool::currentArena = active;
+            return copy;
+        }
+        catch (...) {
+            MemoryPool::currentArena = active;
+            throw;
+        }
+    }
+
+private:
+    friend class MemoryPool;
+
+    void* Allocate(size_t bytes) {
+        bytes = (bytes + alignof(MemoryPool::BlockHeader) - 1) & ~(alignof(MemoryPool::BlockHeader) - 1);
+        if (static_cast<size_t>(chunkEnd - cursor) < bytes) {
+            size_t chunkBytes = std::max(bytes, nextChunkBytes);
+            chunks.push_back(static_cast<char*>(::operator new(chunkBytes)));
+            cursor = chunks.back();
+            chunkEnd = cursor + chunkBytes;
+            reservedBytes += chunkBytes;
+            nextChunkBytes *= 2;
+        }
+        void* block = cursor;
+        cursor += bytes;
+        return block;
+    }
+
+private:
+    std::vector<char*> chunks;
+    char* cursor = nullptr;
+    char* chunkEnd = nullptr;
+    size_t nextChunkBytes;
+    size_t reservedBytes = 0;
+    // Arenas are numbered in creation order, so on one thread an arena is nested
+    // in every live arena with a smaller serial; 0 stands for no arena.
+    uint64_t serial;
+    ComputationArena* previous;
+
+    static inline std::atomic<uint64_t> arenaCount{ 0 };
+};
+
+
+inline void* MemoryPool::Allocate(size_t bytes, uint64_t scope) {
+    constexpr size_t headerBytes = sizeof(BlockHeader);
+    size_t totalBytes = bytes + headerBytes;
+    void* block;
+    uint32_t sizeClass = 0;
+
+    ComputationArena* arena = currentArena;
+    while (arena && arena->serial > scope) {
+        arena = arena->previous;
+    }
+    if (arena) {
+        block = arena->Allocate(totalBytes);
+        sizeClass = ArenaBlock;
+    }
+    else {
+        while (sizeClass < ClassCount && (MinClassBytes << sizeClass) < totalBytes) ++sizeClass;
+        if (sizeClass == ClassCount) {
+            block = ::operator new(totalBytes);
+            sizeClass = LargeBlock;
+        }
+        else if (ThreadCache* cache = Cache(); cache && !cache->freeBlocks[sizeClass].empty()) {
+            block = cache->freeBlocks[sizeClass].back();
+            cache->freeBlocks[sizeClass].pop_back();
+        }
+        else {
+            block = ::operator new(MinClassBytes << sizeClass);
+        }
+    }
+    static_cast<BlockHeader*>(block)->sizeClass = sizeClass;
+    static_cast<BlockHeader*>(block)->arenaSerial = arena ? arena->serial : 0;
+    return static_cast<char*>(block) + headerBytes;
+}
+
+inline uint64_t MemoryPool::CurrentScope() noexcept {
+    return currentArena ? currentArena->serial : 0;
+}
+
+inline bool MemoryPool::IsOwnable(void const* pointer, uint64_t scope) noexcept {
+    auto const* header = reinterpret_cast<BlockHeader const*>(static_cast<char const*>(pointer) - sizeof(BlockHeader));
+    if (header->sizeClass != ArenaBlock) {
+        return true;
+    }
+    if (header->arenaSerial > scope) {
+        return false;
+    }
+    for (ComputationArena* arena = currentArena; arena; arena = arena->previous) {
+        if (arena->serial == header->arenaSerial) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void MemoryPool::Deallocate(void* pointer) noexcept {
+    void* block = static_cast<char*>(pointer) - sizeof(BlockHeader);
+    uint32_t sizeClass = static_cast<BlockHeader*>(block)->sizeClass;
+    if (sizeClass == ArenaBlock) {
+        return;
+    }
+    ThreadCache* cache = (sizeClass != LargeBlock) ? Cache() : nullptr;
+    if (cache && cache->freeBlocks[sizeClass].size() < MaxCachedBlocks) {
+        try {
+            cache->freeBlocks[sizeClass].push_back(block);
+            return;
+        }
+        catch (std::bad_alloc const&) {}
+    }
+    ::operator delete(block);
+}
+
+inline void MemoryPool::Trim() noexcept {
+    if (ThreadCache* cache = Cache()) cache->Release();
+}
+
+inline void MemoryPool::ThreadCache::Release() noexcept {
+    for (std::vector<void*>& blocks : freeBlocks) {
+        for (void* block : blocks) {
+            ::operator delete(block);
+        }
+        blocks.clear();
+    }
+}
+
+
+template<class T>
+struct PoolAllocator {
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template<class U> PoolAllocator(PoolAllocator<U> const&) noexcept {}
+
+    T* allocate(size_t count) {
+        return allocate(count, MemoryPool::CurrentScope());
+    }
+    T* allocate(size_t count, uint64_t scope) {
+        return static_cast<T*>(MemoryPool::Allocate(count * sizeof(T), scope));
+    }
+    void deallocate(T* pointer, size_t) noexcept {
+        MemoryPool::Deallocate(pointer);
+    }
+
+    [[nodiscard]] static uint64_t Scope() noexcept { return MemoryPool::CurrentScope(); }
+    [[nodiscard]] static bool IsOwnable(T const* pointer, uint64_t scope) noexcept {
+        return MemoryPool::IsOwnable(pointer, scope);
+    }
+
+    friend bool operator== (PoolAllocator const&, PoolAllocator const&) noexcept { return true; }
+};
+
+
+// A fixed set of worker threads fed from one task queue. A thread that waits for
+// a task keeps running queued tasks meanwhile, so tasks may submit and wait for
+// subtasks of their own without exhausting the workers.
+class ThreadPool final {
+public:
+    explicit ThreadPool(size_t threadCount) {
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator= (ThreadPool const&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex);
+            isStopping = true;
+        }
+        hasTasks.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return workers.size();
+    }
+
+    template<class F> std::future<std::invoke_result_t<F>> Submit(F task) {
+        auto packagedTask = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::move(task));
+        auto result = packagedTask->get_future();
+        {
+            std::lock_guard lock(mutex);
+            tasks.emplace_back([packagedTask] { (*packagedTask)(); });
+        }
+        hasTasks.notify_one();
+        return result;
+    }
+
+    template<class R> R Wait(std::future<R>& result) {
+        while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!RunPendingTask()) {
+                result.wait();
+            }
+        }
+        return result.get();
+    }
+
+    bool RunPendingTask() {
+        std::function<void()> task;
+        {
+            std::lock_guard lock(mutex);
+            if (tasks.empty()) {
+                return false;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+        return true;
+    }
+
+private:
+    void WorkerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex);
+                hasTasks.wait(lock, [this] { return isStopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable hasTasks;
+    bool isStopping = false;
+};
+
+
+// Nodes of the lazy expression layer built by Lazy(); see LazyTerm below.
+class LazyTerm;
+template<class First, class Second, bool IsDifference> class LazySum;
+template<class First, class Second> class LazyProduct;
+
+template<class T> concept LazyExpression = T::IsLazyExpression;
+
+template<size_t Bits> class FixedInt;
+class NumberBatch;
+class Divisor;
+class NumberStringView;
+
+
+class NumberString {
+public:
+    using Limb = uint32_t;
+    static constexpr Limb Base = 1000000000;
+    static constexpr size_t BaseDigits = 9;
+
+    // Operand sizes in limbs at which operator* switches from schoolbook to
+    // Karatsuba, from Karatsuba to Toom-3 and from Toom-3 to the NTT multiplication.
+    static inline size_t KaratsubaThreshold = 32;
+    static inline size_t Toom3Threshold = 250;
+    static inline size_t FftThreshold = 1500;
+
+    // Divisor and quotient length in limbs from which division switches from
+    // Knuth's Algorithm D to multiplication by a Newton-iterated reciprocal.
+    static inline size_t NewtonDivisionThreshold = 2000;
+
+    // Operand size in limbs from which GCD computations reduce the top halves of
+    // the operands recursively (half-GCD) instead of only taking Lehmer steps.
+    static inline size_t HalfGcdThreshold = 400;
+
+    // Operand size in limbs from which sub-products, transform passes and decimal
+    // conversion are split across the thread pool once SetThreadCount enables it.
+    static inline size_t ParallelThreshold = 1000;
+
+    // Lets limb addition and subtraction use the SSE2, AVX2 or AVX-512 kernel picked
+    // for this CPU at startup; switching it off falls back to the scalar loops.
+    static inline bool UseSimdKernels = true;
+
+    // Opt-in parallel mode: 0 or 1 keeps every operation on the calling thread.
+    // Must not be called while other threads are computing with NumberStrings.
+    static void SetThreadCount(size_t threadCount) {
+        threadPool.reset();
+        if (threadCount > 1) {
+            threadPool = std::make_unique<ThreadPool>(threadCount - 1);
+        }
+    }
+
+    [[nodiscard]] static size_t GetThreadCount() noexcept {
+        return threadPool ? threadPool->Size() + 1 : 1;
+    }
+
+public:
+    NumberString(long long number) : isNegative(number < 0) {
+        unsigned long long magnitude = isNegative
+                ? 0ull - static_cast<unsigned long long>(number)
+                : static_cast<unsigned long long>(number);
+        for (; magnitude != 0; magnitude /= Base) {
+            limbs.push_back(static_cast<Limb>(magnitude % Base));
+        }
+    };
+
+    NumberString(const char* strNum = "0") : isNegative(false) {
+        assert(strNum != nullptr);
+        std::string_view digits{ strNum };
+        if (!digits.empty() && digits.front() == '-') {
+            digits.remove_prefix(1);
+            isNegative = true;
+        }
+        if (digits.empty() || digits.find_first_not_of("0123456789") != std::string_view::npos) {
+            throw std::invalid_argument("NumberString can only be created from decimal digits");
+        }
+
+        limbs.resize((digits.length() + BaseDigits - 1) / BaseDigits);
+        ParallelFor(limbs.size(), [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                size_t chunkEnd = digits.length() - index * BaseDigits;
+                size_t chunkBegin = (chunkEnd > BaseDigits) ? chunkEnd - BaseDigits : 0;
+                Limb limb = 0;
+                for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+                    limb = limb * 10 + (digits[i] - '0');
+                }
+                limbs[index] = limb;
+            }
+        });
+        RemoveTrailingZeros();
+    }
+
+    NumberString(NumberString const&) = default;
+    NumberString(NumberString&&) noexcept = default;
+    ~NumberString() = default;
+
+    template<LazyExpression Expression>
+    NumberString(Expression const& expression) : NumberString(expression.Evaluate()) {}
+
+
+    // Allocates the whole text, and large values are converted on the thread pool,
+    // so this may throw std::bad_alloc or an exception rethrown from a pool task.
+    [[nodiscard]] std::string Get() const {
+        std::string result;
+        if (!IsParallel(limbs.size())) {
+            result.reserve(limbs.size() * BaseDigits + 1);
+            EmitDigits([&result](char const* chunk, size_t length) { result.append(chunk, length); });
+            return result;
+        }
+
+        // Every limb below the top one owns a fixed slot of nine digits.
+        result = (isNegative ? "-" : "") + std::to_string(limbs.back());
+        size_t lowDigitsBegin = result.length();
+        result.resize(lowDigitsBegin + (limbs.size() - 1) * BaseDigits);
+        ParallelFor(limbs.size() - 1, [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                Limb limb = limbs[index];
+                size_t position = result.length() - index * BaseDigits;
+                for (size_t i = 0; i < BaseDigits; ++i, limb /= 10) {
+                    result[--position] = static_cast<char>('0' + limb % 10);
+                }
+            }
+        });
+        return result;
+    }
+
+    void WriteTo(FILE* file) const {
+        EmitDigits([file](char const* chunk, size_t length) {
+            if (std::fwrite(chunk, 1, length, file) != length) {
+                throw std::system_error(errno, std::generic_category(), "failed to write NumberString");
+            }
+        });
+    }
+
+    friend std::ostream& operator<< (std::ostream& out, NumberString const& number) {
+        number.EmitDigits([&out](char const* chunk, size_t length) {
+            out.write(chunk, static_cast<std::streamsize>(length));
+        });
+        return out;
+    }
+
+    // Binary wire format, every integer little-endian: the bytes 'N' 'S', the format
+    // version, a flags byte whose bit 0 is the sign, the limb count as a u64 and then
+    // the base 10^9 limbs as u32, lowest first. Records are a multiple of four bytes
+    // long, so records packed back to back keep their limbs aligned.
+    static constexpr uint8_t SerialFormatVersion = 1;
+    static constexpr size_t SerialHeaderSize = 12;
+
+    [[nodiscard]] size_t GetSerializedSize() const noexcept {
+        return SerialHeaderSize + limbs.size() * sizeof(Limb);
+    }
+    // Writes the record to the front of buffer and returns its size in bytes.
+    size_t Serialize(std::span<std::byte> buffer) const;
+    [[nodiscard]] static NumberString Deserialize(std::span<std::byte const> data);
+    explicit NumberString(NumberStringView const& view);
+
+    NumberString& operator= (NumberString const&) = default;
+    NumberString& operator= (NumberString&&) = default;
+
+    template<LazyExpression Expression>
+    NumberString& operator= (Expression const& expression) {
+        return *this = expression.Evaluate();
+    }
+
+    // The rvalue overloads compute the result in the buffer of the temporary operand.
+    friend NumberString operator+ (NumberString const& firstNum, NumberString const& secondNum);
+    friend NumberString operator+ (NumberString&& firstNum, NumberString const& secondNum);
+    friend NumberString operator+ (NumberString const& firstNum, NumberString&& secondNum);
+    friend NumberString operator+ (NumberString&& firstNum, NumberString&& secondNum);
+    friend NumberString operator- (NumberString const& firstNum, NumberString const& secondNum);
+    friend NumberString operator- (NumberString&& firstNum, NumberString const& secondNum);
+    friend NumberString operator- (NumberString const& firstNum, NumberString&& secondNum);
+    friend NumberString operator- (NumberString&& firstNum, NumberString&& secondNum);
+    friend NumberString operator* (NumberString const& firstNum, NumberString const& secondNum);
+    friend NumberString operator* (NumberString&& firstNum, NumberString const& secondNum);
+    friend NumberString operator/ (NumberString const& firstNum, NumberString const& secondNum);
+    friend NumberString operator/ (NumberString&& firstNum, NumberString const& secondNum);
+    friend NumberString operator% (const NumberString& firstNum, const NumberString& secondNum);
+    friend std::pair<NumberString, NumberString> DivMod(NumberString const& dividend,
+                                                        NumberString const& divisor);
+    friend NumberString operator^ (const NumberString& number, const NumberString& power);
+    friend NumberString PowMod(NumberString const& base, NumberString const& exponent,
+                               NumberString const& modulus);
+    friend NumberString operator! (const NumberString& number);
+    friend NumberString Binomial(NumberString const& n, NumberString const& k);
+    friend NumberString Primorial(NumberString const& n);
+    friend NumberString IRoot(NumberString const& number, unsigned degree);
+    friend NumberString ISqrt(NumberString const& number);
+    friend NumberString Gcd(NumberString const& firstNum, NumberString const& secondNum);
+    friend std::tuple<NumberString, NumberString, NumberString> ExtendedGcd(NumberString const& firstNum,
+                                                                         NumberString const& secondNum);
+    friend NumberString ModInverse(NumberString const& number, NumberString const& modulus);
+    friend NumberString operator/ (NumberString const& dividend, Divisor const& divisor);
+    friend NumberString operator% (NumberString const& dividend, Divisor const& divisor);
+    friend std::pair<NumberString, NumberString> DivMod(NumberString const& dividend, Divisor const& divisor);
+
+
+    NumberString& operator+= (const NumberString& other) {
+        return AddInPlace(other.limbs, other.isNegative);
+    }
+    NumberString& operator-= (const NumberString& other) {
+        return AddInPlace(other.limbs, !other.isNegative);
+    }
+    NumberString& operator*= (const NumberString& other) {
+        bool isProductNegative = this->isNegative != other.isNegative;
+        __int128 nativeProduct;
+        if (FitsNative() && other.FitsNative()
+            && !__builtin_mul_overflow(ToNative(), other.ToNative(), &nativeProduct)) {
+            AssignNative(nativeProduct);
+            return *this;
+        }
+        if (other.limbs.size() == 1) {
+            MultiplyAddSmall(limbs, other.limbs.front(), 0);
+        }
+        else {
+            limbs = MultiplyMagnitudes(limbs, other.limbs);
+        }
+        isNegative = isProductNegative;
+        RemoveTrailingZeros();
+        return *this;
+    }
+    NumberString& operator/= (const NumberString& other) {
+        if (other.IsZero()) {
+            throw std::overflow_error("Division by zero exception");
+        }
+        if (FitsNative() && other.FitsNative()) {
+            AssignNative(ToNative() / other.ToNative());
+            return *this;
+        }
+        bool isQuotientNegative = this->isNegative != other.isNegative;
+        if (other.limbs.size() == 1) {
+            DivideSmall(limbs, other.limbs.front());
+        }
+        else {
+            Limbs quotient, remainder;
+            DivideMagnitudes(limbs, other.limbs, quotient, remainder);
+            limbs = std::move(quotient);
+        }
+        isNegative = isQuotientNegative;
+        RemoveTrailingZeros();
+        return *this;
+    }
+    NumberString& operator%= (const NumberString& other) {
+        return *this = *this % other;
+    }
+    NumberString& operator^= (const NumberString& other) {
+        return *this = *this ^ other;
+    }
+
+    template<LazyExpression Expression>
+    NumberString& operator+= (Expression const& expression) {
+        expression.AccumulateInto(*this, false);
+        return *this;
+    }
+    template<LazyExpression Expression>
+    NumberString& operator-= (Expression const& expression) {
+        expression.AccumulateInto(*this, true);
+        return *this;
+    }
+
+    bool operator== (NumberString const& other) const noexcept {
+        return this->isNegative == other.isNegative && this->limbs == other.limbs;
+    }
+
+    bool operator!= (NumberString const& other) const noexcept {
+        return !(*this == other);
+    }
+
+
+    bool operator> (NumberString const& other) const noexcept {
+        if (this->isNegative != other.isNegative) {
+            return other.isNegative;
+        }
+        int comparison = CompareMagnitudes(this->limbs, other.limbs);
+        return this->isNegative ? comparison < 0 : comparison > 0;
+    }
+
+    bool operator< (NumberString const& other) const noexcept {
+        return other > *this;
+    }
+
+    bool operator>= (NumberString const& other) const noexcept {
+        return !(*this < other);
+    }
+
+    bool operator<= (NumberString const& other) const noexcept {
+        return !(*this > other);
+    }
+
+    // Mixes the sign and the limbs, so hashing needs no conversion to digits.
+    [[nodiscard]] size_t Hash() const noexcept {
+        size_t seed = std::hash<bool>{}(isNegative);
+        for (Limb limb : limbs) {
+            seed ^= std::hash<Limb>{}(limb) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+
+private:
+    // Magnitudes are little-endian vectors of base 10^9 limbs without high zero limbs,
+    // so zero is the empty vector and is never negative. Five limbs cover every
+    // 128-bit value, and values that small are stored without touching the heap.
+    using Limbs = SmallVector<Limb, 5, PoolAllocator<Limb>>;
+
+    // Operands below 10^36 < 2^127 take a native __int128 fast path.
+    static constexpr size_t NativeLimbs = 4;
+
+    static int CompareMagnitudes(Limbs const& first, Limbs const& second) noexcept;
+    static Limb AddLimbs(Limb* result, Limb const* first, Limb const* second, size_t count,
+                         Limb carry = 0) noexcept;
+    static Limb SubtractLimbs(Limb* result, Limb const* first, Limb const* second, size_t count,
+                              Limb borrow = 0) noexcept;
+    static Limbs AddMagnitudes(Limbs const& first, Limbs const& second);
+    static Limbs SubtractMagnitudes(Limbs const& greater, Limbs const& lesser);
+    static Limbs MultiplyMagnitudes(Limbs const& first, Limbs const& second);
+    static Limbs SchoolbookMultiply(Limbs const& first, Limbs const& second);
+    static Limbs KaratsubaMultiply(Limbs const& first, Limbs const& second);
+    static Limbs Toom3Multiply(Limbs const& first, Limbs const& second);
+    static Limbs FftMultiply(Limbs const& first, Limbs const& second);
+    // The transforms run modulo three NTT primes and the product limbs are rebuilt
+    // by the CRT. Their product exceeds MaxFftLength * (Base - 1)^2, so no
+    // convolution coefficient can wrap; longer products are split by Toom-3 first.
+    static constexpr size_t MaxFftLength = size_t{ 1 } << 23;
+    template<uint32_t Modulus, uint32_t PrimitiveRoot>
+    static void NumberTheoreticTransform(std::vector<uint32_t>& values, bool isInverse);
+    static void MultiplyAddSmall(Limbs& magnitude, Limb multiplier, Limb addend);
+    static Limb DivideSmall(Limbs& magnitude, Limb divisor) noexcept;
+
+    static void DivideMagnitudes(Limbs const& dividend, Limbs const& divisor,
+                                 Limbs& quotient, Limbs& remainder);
+    static void KnuthDivide(Limbs const& dividend, Limbs const& divisor,
+                            Limbs& quotient, Limbs& remainder);
+    static void KnuthDivide(Limbs const& dividend, Limbs const& normalizedDivisor, Limb scale,
+                            Limbs& quotient, Limbs& remainder);
+    static void NewtonDivide(Limbs const& dividend, Limbs const& divisor, Limbs const& reciprocal,
+                             Limbs& quotient, Limbs& remainder);
+    static Limbs ReciprocalMagnitude(Limbs const& divisor);
+    static void BarrettDivide(Limbs const& value, Limbs const& modulus, Limbs const& reciprocal,
+                              Limbs& quotient, Limbs& remainder);
+
+    static std::vector<bool> ToBinaryDigits(Limbs magnitude);
+    static bool TryGetUnsigned(Limbs const& magnitude, unsigned long long& value) noexcept;
+
+    // Largest argument for which the prime-based factorial, binomial and primorial
+    // engines sieve primes; beyond it the results would not fit in memory anyway.
+    static constexpr uint32_t MaxSieveLimit = uint32_t{ 1 } << 28;
+
+    static std::vector<uint32_t> SievePrimes(uint32_t limit);
+    template<class Factor>
+    static NumberString ProductTree(std::vector<Factor> const& factors, size_t from, size_t to);
+    static NumberString PrimeSwingFactorial(uint32_t n, std::vector<uint32_t> const& primes);
+    template<class Multiply>
+    static NumberString SlidingWindowPower(NumberString const& base, NumberString const& exponent,
+                                           Multiply multiply);
+
+    static NumberString RootMagnitude(Limbs const& magnitude, unsigned degree);
+
+    struct GcdMatrix;
+    static void ReduceGcd(NumberString& first, NumberString& second, size_t targetLength, GcdMatrix* matrix);
+    static void LehmerStep(NumberString& first, NumberString& second, GcdMatrix* matrix);
+    static void ApplyGcdMatrix(GcdMatrix step, NumberString& first, NumberString& second, GcdMatrix* matrix);
+
+    static void TrimMagnitude(Limbs& magnitude) noexcept;
+    static Limbs SliceMagnitude(Limbs const& magnitude, size_t from, size_t to);
+    static void AddShiftedMagnitude(Limbs& accumulator, Limbs const& addend, size_t shift);
+    static bool SubtractMagnitudeInPlace(Limbs& accumulator, Limbs const& subtrahend);
+
+    NumberString& AddInPlace(Limbs const& magnitude, bool isMagnitudeNegative);
+
+    template<size_t Bits> friend class FixedInt;
+    friend class NumberBatch;
+    friend class Divisor;
+    friend class NumberStringView;
+    friend class BigFloat;
+
+    friend class LazyTerm;
+    template<class First, class Second, bool IsDifference> friend class LazySum;
+    template<class First, class Second> friend class LazyProduct;
+
+    struct SignedTerm {
+        Limbs const* magnitude;
+        bool isNegative;
+    };
+    using SignedTerms = SmallVector<SignedTerm, 8>;
+
+    template<class Expression>
+    static NumberString EvaluateSum(Expression const& expression, NumberString const* accumulator,
+                                    bool isNegated);
+    static NumberString FusedSum(SignedTerms const& terms);
+    NumberString& MultiplyAccumulate(NumberString const& first, NumberString const& second, bool isNegated);
+
+    template<class Sink> void EmitDigits(Sink&& sink) const;
+
+    [[nodiscard]] static bool IsParallel(size_t workSize) noexcept {
+        return threadPool && workSize >= ParallelThreshold;
+    }
+    template<class... Tasks> static void RunParallel(size_t workSize, Tasks&&... tasks);
+    template<class Body> static void ParallelFor(size_t count, Body&& body);
+    static void WaitForAll(std::vector<std::future<void>>& results, std::exception_ptr failure);
+
+    static inline std::unique_ptr<ThreadPool> threadPool;
+
+    [[nodiscard]] bool FitsNative() const noexcept {
+        return limbs.size() <= NativeLimbs;
+    }
+    [[nodiscard]] __int128 ToNative() const noexcept {
+        auto magnitude = static_cast<__int128>(NativeMagnitude(limbs));
+        return isNegative ? -magnitude : magnitude;
+    }
+    static unsigned __int128 NativeMagnitude(Limbs const& magnitude) noexcept;
+    void AssignNative(__int128 value) noexcept;
+
+    void RemoveTrailingZeros() noexcept {
+        TrimMagnitude(limbs);
+        if (IsZero()) isNegative = false;
+    }
+
+    [[nodiscard]] bool IsZero() const noexcept {
+        return limbs.empty();
+    }
+
+private:
+    // Values may outlive any arena they are computed in, so only scratch buffers
+    // come from arenas.
+    Limbs limbs{ Limbs::OutermostScope{} };
+    bool isNegative;
+};
+
+
+// Unimodular 2x2 matrix mapping the starting GCD operands (x, y) onto the current
+// pair (topLeft * x + topRight * y, bottomLeft * x + bottomRight * y).
+struct NumberString::GcdMatrix {
+    NumberString topLeft{ 1ll }, topRight, bottomLeft, bottomRight{ 1ll };
+};
+
+// A divisor prepared once for dividing many numbers by it. A long divisor keeps
+// its reciprocal floor(Base^(2n) / |divisor|), so every division afterwards costs
+// two multiplications per n-limb block of the dividend instead of a long division;
+// a shorter one keeps the scaled divisor of Algorithm D, and a one-limb divisor is
+// applied through a 64-bit fixed-point inverse instead of a hardware division per
+// limb. Results match operator/ and operator%.
+class Divisor final {
+public:
+    // Divisor length in limbs from which divisions go through the cached reciprocal
+    // instead of Algorithm D.
+    static inline size_t BarrettThreshold = 300;
+
+    explicit Divisor(NumberString const& divisor);
+
+    [[nodiscard]] NumberString const& GetValue() const noexcept { return value; }
+
+    friend NumberString operator/ (NumberString const& dividend, Divisor const& divisor);
+    friend NumberString operator% (NumberString const& dividend, Divisor const& divisor);
+    friend std::pair<NumberString, NumberString> DivMod(NumberString const& dividend, Divisor const& divisor);
+
+private:
+    using Limbs = NumberString::Limbs;
+    using Limb = NumberString::Limb;
+
+    void DivideMagnitudes(Limbs const& dividend, Limbs& quotient, Limbs& remainder) const;
+    Limb DivideSmall(Limbs& magnitude) const noexcept;
+
+private:
+    NumberString value;
+    Limbs reciprocal{ Limbs::OutermostScope{} };
+    Limbs normalizedDivisor{ Limbs::OutermostScope{} };
+    Limb scale = 1;
+    uint64_t inverse = 0;
+};
+
+template<std::unsigned_integral T>
+T LoadLittleEndian(std::byte const* source) noexcept {
+    T value;
+    std::memcpy(&value, source, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) {
+        T swapped = 0;
+        for (size_t i = 0; i < sizeof(T); ++i, value >>= 8) swapped = (swapped << 8) | (value & 0xff);
+        value = swapped;
+    }
+    return value;
+}
+
+template<std::unsigned_integral T>
+void StoreLittleEndian(std::byte* destination, T value) noexcept {
+    for (size_t i = 0; i < sizeof(T); ++i, value >>= 8) {
+        destination[i] = static_cast<std::byte>(value & 0xff);
+    }
+}
+
+// Read-only NumberString over one serialized record, e.g. inside a memory-mapped
+// archive. Construction only checks the header, so opening a record costs O(1) and
+// copies nothing; the limbs are read in place when asked for, and converting to a
+// NumberString validates them all. GetSerializedSize() is the offset of the next
+// record.
+class NumberStringView final {
+public:
+    using Limb = NumberString::Limb;
+
+    explicit NumberStringView(std::span<std::byte const> data);
+
+    [[nodiscard]] bool IsNegative() const noexcept { return isNegative; }
+    [[nodiscard]] bool IsZero() const noexcept { return limbCount == 0; }
+    [[nodiscard]] size_t GetLimbCount() const noexcept { return limbCount; }
+    [[nodiscard]] size_t GetSerializedSize() const noexcept {
+        return NumberString::SerialHeaderSize + limbCount * sizeof(Limb);
+    }
+
+    [[nodiscard]] Limb GetLimb(size_t index) const noexcept {
+        assert(index < limbCount);
+        return LoadLittleEndian<Limb>(limbData + index * sizeof(Limb));
+    }
+
+    [[nodiscard]] std::string Get() const {
+        return NumberString(*this).Get();
+    }
+
+    friend bool operator== (NumberStringView const& view, NumberString const& number) noexcept {
+        return view.Compare(number) == 0;
+    }
+    friend std::strong_ordering operator<=> (NumberStringView const& view, NumberString const& number) noexcept {
+        return view.Compare(number) <=> 0;
+    }
+
+    friend std::ostream& operator<< (std::ostream& out, NumberStringView const& view) {
+        return out << NumberString(view);
+    }
+
+private:
+    [[nodiscard]] int Compare(NumberString const& number) const noexcept;
+
+    friend class NumberString;
+
+private:
+    std::byte const* limbData;
+    size_t limbCount;
+    bool isNegative;
+};
+
+// Lazy arithmetic: Lazy(a) + b - c * d builds a tree of operand references that is
+// only evaluated once it is stored into a NumberString. All the terms of a sum or
+// difference are then added column by column in a single carry pass, products are
+// computed once each, and acc += Lazy(a) * b multiplies straight into acc. The nodes
+// keep references, so an expression must be consumed in the full-expression that
+// built it.
+class LazyTerm final {
+public:
+    static constexpr bool IsLazyExpression = true;
+    static constexpr size_t ProductCount = 0;
+
+    explicit LazyTerm(NumberString const& _value) noexcept : value(&_value) {}
+
+    [[nodiscard]] NumberString const& Evaluate() const noexcept {
+        return *value;
+    }
+
+    template<class Terms>
+    void AppendTerms(Terms& terms, std::vector<NumberString>&, bool isNegated) const {
+        terms.push_back({ &value->limbs, value->isNegative != isNegated });
+    }
+
+    void AccumulateInto(NumberString& accumulator, bool isNegated) const {
+        accumulator.AddInPlace(value->limbs, value->isNegative != isNegated);
+    }
+
+private:
+    NumberString const* value;
+};
+
+template<class First, class Second, bool IsDifference>
+class LazySum final {
+public:
+    static constexpr bool IsLazyExpression = true;
+    static constexpr size_t ProductCount = First::ProductCount + Second::ProductCount;
+
+    LazySum(First _first, Second _second) noexcept : first(_first), second(_second) {}
+
+    [[nodiscard]] NumberString Evaluate() const {
+        return NumberString::EvaluateSum(*this, nullptr, false);
+    }
+
+    template<class Terms>
+    void AppendTerms(Terms& terms, std::vector<NumberString>& products, bool isNegated) const {
+        first.AppendTerms(terms, products, isNegated);
+        second.AppendTerms(terms, products, isNegated != IsDifference);
+    }
+
+    void AccumulateInto(NumberString& accumulator, bool isNegated) const {
+        accumulator = NumberString::EvaluateSum(*this, &accumulator, isNegated);
+    }
+
+private:
+    First first;
+    Second second;
+};
+
+template<class First, class Second>
+class LazyProduct final {
+public:
+    static constexpr bool IsLazyExpression = true;
+    static constexpr size_t ProductCount = 1;
+
+    LazyProduct(First _first, Second _second) noexcept : first(_first), second(_second) {}
+
+    [[nodiscard]] NumberString Evaluate() const {
+        return first.Evaluate() * second.Evaluate();
+    }
+
+    template<class Terms>
+    void AppendTerms(Terms& terms, std::vector<NumberString>& products, bool isNegated) const {
+        products.push_back(Evaluate());
+        LazyTerm(products.back()).AppendTerms(terms, products, isNegated);
+    }
+
+    void AccumulateInto(NumberString& accumulator, bool isNegated) const {
+        decltype(auto) firstValue = first.Evaluate();
+        decltype(auto) secondValue = second.Evaluate();
+        accumulator.MultiplyAccumulate(firstValue, secondValue, isNegated);
+    }
+
+private:
+    First first;
+    Second second;
+};
+
+template<class T> concept LazyOperand = LazyExpression<T> || std::same_as<T, NumberString>;
+
+[[nodiscard]] inline LazyTerm Lazy(NumberString const& value) noexcept {
+    return LazyTerm{ value };
+}
+
+template<LazyOperand T> auto AsLazy(T const& operand) noexcept {
+    if constexpr (LazyExpression<T>) return operand;
+    else return LazyTerm{ operand };
+}
+
+// The operands are forwarding references, so a NumberString rvalue such as c * d
+// binds exactly. A lazy operator then needs no conversion on any operand and
+// always beats the NumberString&& overloads, which would first have to convert
+// the lazy operand into a NumberString.
+template<class First, class Second>
+concept LazyOperands = LazyOperand<std::remove_cvref_t<First>> && LazyOperand<std::remove_cvref_t<Second>>
+                       && (LazyExpression<std::remove_cvref_t<First>> || LazyExpression<std::remove_cvref_t<Second>>);
+
+template<class First, class Second> requires LazyOperands<First, Second>
+auto operator+ (First&& first, Second&& second) noexcept {
+    return LazySum<decltype(AsLazy(first)), decltype(AsLazy(second)), false>{ AsLazy(first), AsLazy(second) };
+}
+
+template<class First, class Second> requires LazyOperands<First, Second>
+auto operator- (First&& first, Second&& second) noexcept {
+    return LazySum<decltype(AsLazy(first)), decltype(AsLazy(second)), true>{ AsLazy(first), AsLazy(second) };
+}
+
+template<class First, class Second> requires LazyOperands<First, Second>
+auto operator* (First&& first, Second&& second) noexcept {
+    return LazyProduct<decltype(AsLazy(first)), decltype(AsLazy(second))>{ AsLazy(first), AsLazy(second) };
+}
+
+template<class Expression>
+NumberString NumberString::EvaluateSum(Expression const& expression, NumberString const* accumulator,
+                                       bool isNegated) {
+    // Reserving every product slot up front keeps the term pointers into it valid.
+    std::vector<NumberString> products;
+    products.reserve(Expression::ProductCount);
+    SignedTerms terms;
+    if (accumulator) {
+        terms.push_back({ &accumulator->limbs, accumulator->isNegative });
+    }
+    expression.AppendTerms(terms, products, isNegated);
+    return FusedSum(terms);
+}
+
+
+template<class Sink>
+void NumberString::EmitDigits(Sink&& sink) const {
+    // The decimal text is produced in fixed-size chunks straight from the limbs,
+    // so printing a huge value never builds one string of all its digits.
+    constexpr size_t bufferLength = 4096;
+    char buffer[bufferLength];
+    size_t used = 0;
+
+    if (isNegative) {
+        buffer[used++] = '-';
+    }
+    if (IsZero()) {
+        buffer[used++] = '0';
+        sink(buffer, used);
+        return;
+    }
+    used = std::to_chars(buffer + used, buffer + bufferLength, limbs.back()).ptr - buffer;
+
+    for (size_t i = limbs.size() - 1; i-- > 0; used += BaseDigits) {
+        if (used + BaseDigits > bufferLength) {
+            sink(buffer, used);
+            used = 0;
+        }
+        Limb limb = limbs[i];
+        for (size_t position = BaseDigits; position-- > 0; limb /= 10) {
+            buffer[used + position] = static_cast<char>('0' + limb % 10);
+        }
+    }
+    sink(buffer, used);
+}
+
+template<class... Tasks>
+void NumberString::RunParallel(size_t workSize, Tasks&&... tasks) {
+    // All tasks but the last go to the pool and the calling thread runs the last one.
+    if (!IsParallel(workSize)) {
+        (tasks(), ...);
+        return;
+    }
+    std::vector<std::future<void>> results;
+    std::exception_ptr failure;
+    try {
+        auto runTask = [&results](auto& task, bool isLast) {
+            if (isLast) task();
+            else results.push_back(threadPool->Submit([&task] { task(); }));
+        };
+        size_t index = 0;
+        (runTask(tasks, ++index == sizeof...(Tasks)), ...);
+    }
+    catch (...) {
+        failure = std::current_exception();
+    }
+    WaitForAll(results, failure);
+}
+
+template<class Body>
+void NumberString::ParallelFor(size_t count, Body&& body) {
+    // Calls body(from, to) on disjoint ranges that together cover [0, count).
+    if (!IsParallel(count)) {
+        body(size_t{ 0 }, count);
+        return;
+    }
+    size_t chunkCount = threadPool->Size() + 1;
+    size_t chunkLength = (count + chunkCount - 1) / chunkCount;
+    std::vector<std::future<void>> results;
+    std::exception_ptr failure;
+    try {
+        for (size_t from = chunkLength; from < count; from += chunkLength) {
+            results.push_back(threadPool->Submit([&body, from, to = std::min(from + chunkLength, count)] {
+                body(from, to);
+            }));
+        }
+        body(size_t{ 0 }, std::min(chunkLength, count));
+    }
+    catch (...) {
+        failure = std::current_exception();
+    }
+    WaitForAll(results, failure);
+}
+
+inline void NumberString::WaitForAll(std::vector<std::future<void>>& results, std::exception_ptr failure) {
+    // Every submitted task refers to the caller's stack, so all of them are waited
+    // for before the first failure is rethrown.
+    for (std::future<void>& result : results) {
+        try {
+            threadPool->Wait(result);
+        }
+        catch (...) {
+            if (!failure) failure = std::current_exception();
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+namespace detail {
+
+using LimbKernel = uint32_t (*)(uint32_t*, uint32_t const*, uint32_t const*, size_t, uint32_t) noexcept;
+inline constexpr uint32_t LimbBase = NumberString::Base;
+
+inline uint32_t AddLimbsScalar(uint32_t* result, uint32_t const* first, uint32_t const* second,
+                               size_t count, uint32_t carry) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t sum = first[i] + second[i] + carry;
+        carry = (sum >= LimbBase);
+        result[i] = carry ? sum - LimbBase : sum;
+    }
+    return carry;
+}
+
+inline uint32_t SubtractLimbsScalar(uint32_t* result, uint32_t const* first, uint32_t const* second,
+                                    size_t count, uint32_t borrow) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t subtrahend = second[i] + borrow;
+        borrow = (first[i] < subtrahend);
+        result[i] = borrow ? first[i] + LimbBase - subtrahend : first[i] - subtrahend;
+    }
+    return borrow;
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+
+// Carry-lookahead across the lanes of one vector. A lane generates a carry when its
+// sum reaches the base and propagates an incoming one when the sum is base - 1.
+// Adding the shifted generate mask to the propagate mask ripples every carry through
+// the propagating lanes, and the bits that differ from the propagate mask are the
+// lanes receiving a carry. Limbs stay below 2^31, so signed compares are exact.
+inline uint32_t ResolveCarries(uint32_t generate, uint32_t propagate, uint32_t carry,
+                               unsigned lanes, uint32_t& carriedLanes) noexcept {
+    uint32_t rippled = ((generate << 1) | carry) + propagate;
+    carriedLanes = (rippled ^ propagate) & ((1u << lanes) - 1);
+    return (rippled >> lanes) & 1;
+}
+
+__attribute__((target("sse2")))
+inline uint32_t AddLimbsSse2(uint32_t* result, uint32_t const* first, uint32_t const* second,
+                             size_t count, uint32_t carry) noexcept {
+    const __m128i baseMinusOne = _mm_set1_epi32(LimbBase - 1), base = _mm_set1_epi32(LimbBase);
+    const __m128i laneBits = _mm_setr_epi32(1, 2, 4, 8);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i sum = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(first + i)),
+                                    _mm_loadu_si128(reinterpret_cast<__m128i const*>(second + i)));
+        uint32_t generate = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(sum, baseMinusOne)));
+        uint32_t propagate = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(sum, baseMinusOne)));
+        uint32_t carriedLanes;
+        carry = ResolveCarries(generate, propagate, carry, 4, carriedLanes);
+
+        __m128i carries = _mm_and_si128(_mm_set1_epi32(static_cast<int>(carriedLanes)), laneBits);
+        sum = _mm_sub_epi32(sum, _mm_cmpeq_epi32(carries, laneBits));
+        sum = _mm_sub_epi32(sum, _mm_and_si128(_mm_cmpgt_epi32(sum, baseMinusOne), base));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), sum);
+    }
+    return AddLimbsScalar(result + i, first + i, second + i, count - i, carry);
+}
+
+__attribute__((target("sse2")))
+inline uint32_t SubtractLimbsSse2(uint32_t* result, uint32_t const* first, uint32_t const* second,
+                                  size_t count, uint32_t borrow) noexcept {
+    const __m128i zero = _mm_setzero_si128(), base = _mm_set1_epi32(LimbBase);
+    const __m128i laneBits = _mm_setr_epi32(1, 2, 4, 8);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i difference = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(first + i)),
+                                           _mm_loadu_si128(reinterpret_cast<__m128i const*>(second + i)));
+        uint32_t generate = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(zero, difference)));
+        uint32_t propagate = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(difference, zero)));
+        uint32_t borrowedLanes;
+        borrow = ResolveCarries(generate, propagate, borrow, 4, borrowedLanes);
+
+        __m128i borrows = _mm_and_si128(_mm_set1_epi32(static_cast<int>(borrowedLanes)), laneBits);
+        difference = _mm_add_epi32(difference, _mm_cmpeq_epi32(borrows, laneBits));
+        difference = _mm_add_epi32(difference, _mm_and_si128(_mm_cmpgt_epi32(zero, difference), base));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), difference);
+    }
+    return SubtractLimbsScalar(result + i, first + i, second + i, count - i, borrow);
+}
+
+__attribute__((target("avx2")))
+inline uint32_t AddLimbsAvx2(uint32_t* result, uint32_t const* first, uint32_t const* second,
+                             size_t count, uint32_t carry) noexcept {
+    const __m256i baseMinusOne = _mm256_set1_epi32(LimbBase - 1), base = _mm256_set1_epi32(LimbBase);
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i sum = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(first + i)),
+                                       _mm256_loadu_si256(reinterpret_cast<__m256i const*>(second + i)));
+        uint32_t generate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(sum, baseMinusOne)));
+        uint32_t propagate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(sum, baseMinusOne)));
+        uint32_t carriedLanes;
+        carry = ResolveCarries(generate, propagate, carry, 8, carriedLanes);
+
+        __m256i carries = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(carriedLanes)), laneBits);
+        sum = _mm256_sub_epi32(sum, _mm256_cmpeq_epi32(carries, laneBits));
+        sum = _mm256_sub_epi32(sum, _mm256_and_si256(_mm256_cmpgt_epi32(sum, baseMinusOne), base));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), sum);
+    }
+    return AddLimbsSse2(result + i, first + i, second + i, count - i, carry);
+}
+
+__attribute__((target("avx2")))
+inline uint32_t SubtractLimbsAvx2(uint32_t* result, uint32_t const* first, uint32_t const* second,
+                                  size_t count, uint32_t borrow) noexcept {
+    const __m256i zero = _mm256_setzero_si256(), base = _mm256_set1_epi32(LimbBase);
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i difference = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(first + i)),
+                                              _mm256_loadu_si256(reinterpret_cast<__m256i const*>(second + i)));
+        uint32_t generate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(zero, difference)));
+        uint32_t propagate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(difference, zero)));
+        uint32_t borrowedLanes;
+        borrow = ResolveCarries(generate, propagate, borrow, 8, borrowedLanes);
+
+        __m256i borrows = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(borrowedLanes)), laneBits);
+        difference = _mm256_add_epi32(difference, _mm256_cmpeq_epi32(borrows, laneBits));
+        difference = _mm256_add_epi32(difference, _mm256_and_si256(_mm256_cmpgt_epi32(zero, difference), base));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), difference);
+    }
+    return SubtractLimbsSse2(result + i, first + i, second + i, count - i, borrow);
+}
+
+__attribute__((target("avx512f")))
+inline uint32_t AddLimbsAvx512(uint32_t* result, uint32_t const* first, uint32_t const* second,
+                               size_t count, uint32_t carry) noexcept {
+    const __m512i baseMinusOne = _mm512_set1_epi32(LimbBase - 1), base = _mm512_set1_epi32(LimbBase);
+    const __m512i one = _mm512_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i sum = _mm512_add_epi32(_mm512_loadu_si512(first + i), _mm512_loadu_si512(second + i));
+        uint32_t generate = _mm512_cmpgt_epi32_mask(sum, baseMinusOne);
+        uint32_t propagate = _mm512_cmpeq_epi32_mask(sum, baseMinusOne);
+        uint32_t carriedLanes;
+        carry = ResolveCarries(generate, propagate, carry, 16, carriedLanes);
+
+        sum = _mm512_mask_add_epi32(sum, static_cast<__mmask16>(carriedLanes), sum, one);
+        sum = _mm512_mask_sub_epi32(sum, _mm512_cmpgt_epi32_mask(sum, baseMinusOne), sum, base);
+        _mm512_storeu_si512(result + i, sum);
+    }
+    return AddLimbsSse2(result + i, first + i, second + i, count - i, carry);
+}
+
+__attribute__((target("avx512f")))
+inline uint32_t SubtractLimbsAvx512(uint32_t* result, uint32_t const* first, uint32_t const* second,
+                                    size_t count, uint32_t borrow) noexcept {
+    const __m512i zero = _mm512_setzero_si512(), base = _mm512_set1_epi32(LimbBase);
+    const __m512i one = _mm512_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i difference = _mm512_sub_epi32(_mm512_loadu_si512(first + i), _mm512_loadu_si512(second + i));
+        uint32_t generate = _mm512_cmpgt_epi32_mask(zero, difference);
+        uint32_t propagate = _mm512_cmpeq_epi32_mask(difference, zero);
+        uint32_t borrowedLanes;
+        borrow = ResolveCarries(generate, propagate, borrow, 16, borrowedLanes);
+
+        difference = _mm512_mask_sub_epi32(difference, static_cast<__mmask16>(borrowedLanes), difference, one);
+        difference = _mm512_mask_add_epi32(difference, _mm512_cmpgt_epi32_mask(zero, difference), difference, base);
+        _mm512_storeu_si512(result + i, difference);
+    }
+    return SubtractLimbsSse2(result + i, first + i, second + i, count - i, borrow);
+}
+
+#endif
+
+inline std::pair<LimbKernel, LimbKernel> SelectLimbKernels() noexcept {
+#if defined(__GNUC__) && defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return { AddLimbsAvx512, SubtractLimbsAvx512 };
+    if (__builtin_cpu_supports("avx2")) return { AddLimbsAvx2, SubtractLimbsAvx2 };
+    return { AddLimbsSse2, SubtractLimbsSse2 };
+#else
+    return { AddLimbsScalar, SubtractLimbsScalar };
+#endif
+}
+
+}  // namespace detail
+
+inline NumberString::Limb NumberString::AddLimbs(Limb* result, Limb const* first, Limb const* second,
+                                                 size_t count, Limb carry) noexcept {
+    static detail::LimbKernel const addKernel = detail::SelectLimbKernels().first;
+    return (UseSimdKernels ? addKernel : detail::AddLimbsScalar)(result, first, second, count, carry);
+}
+
+inline NumberString::Limb NumberString::SubtractLimbs(Limb* result, Limb const* first, Limb const* second,
+                                                      size_t count, Limb borrow) noexcept {
+    static detail::LimbKernel const subtractKernel = detail::SelectLimbKernels().second;
+    return (UseSimdKernels ? subtractKernel : detail::SubtractLimbsScalar)(result, first, second, count, borrow);
+}
+
+inline int NumberString::CompareMagnitudes(Limbs const& first, Limbs const& second) noexcept {
+    if (first.size() != second.size()) {
+        return (first.size() > second.size()) ? 1 : -1;
+    }
+    for (size_t i = first.size(); i-- > 0; ) {
+        if (first[i] != second[i]) {
+            return (first[i] > second[i]) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+inline NumberString::Limbs NumberString::AddMagnitudes(Limbs const& first, Limbs const& second) {
+    Limbs const& longer = (first.size() >= second.size()) ? first : second;
+    Limbs const& shorter = (first.size() >= second.size()) ? second : first;
+    Limbs result(longer.size() + 1);
+
+    Limb carry = AddLimbs(result.data(), longer.data(), shorter.data(), shorter.size());
+    for (size_t i = shorter.size(); i < longer.size(); ++i) {
+        Limb sum = longer[i] + carry;
+        carry = (sum >= Base);
+        result[i] = carry ? sum - Base : sum;
+    }
+    result.back() = carry;
+    return result;
+}
+
+inline NumberString::Limbs NumberString::SubtractMagnitudes(Limbs const& greater, Limbs const& lesser) {
+    assert(CompareMagnitudes(greater, lesser) >= 0);
+    Limbs result(greater.size());
+
+    Limb borrow = SubtractLimbs(result.data(), greater.data(), lesser.data(), lesser.size());
+    for (size_t i = lesser.size(); i < greater.size(); ++i) {
+        result[i] = (greater[i] < borrow) ? greater[i] + Base - borrow : greater[i] - borrow;
+        borrow = (greater[i] < borrow);
+    }
+    return result;
+}
+
+inline NumberString::Limbs NumberString::MultiplyMagnitudes(Limbs const& first, Limbs const& second) {
+    Limbs const& longer = (first.size() >= second.size()) ? first : second;
+    Limbs const& shorter = (first.size() >= second.size()) ? second : first;
+    if (shorter.size() < KaratsubaThreshold) {
+        return SchoolbookMultiply(longer, shorter);
+    }
+
+    // Unbalanced operands are cut into pieces of the shorter length, so that
+    // every sub-product keeps the balanced shape the recursive tiers expect.
+    if (longer.size() >= 2 * shorter.size()) {
+        size_t pieceCount = (longer.size() + shorter.size() - 1) / shorter.size();
+        std::vector<std::pair<size_t, Limbs>> partialSums;
+        std::mutex partialSumsMutex;
+        ParallelFor(pieceCount * shorter.size(), [&](size_t from, size_t to) {
+            size_t firstPiece = (from + shorter.size() - 1) / shorter.size();
+            size_t lastPiece = (to + shorter.size() - 1) / shorter.size();
+            Limbs partialSum;
+            for (size_t piece = firstPiece; piece < lastPiece; ++piece) {
+                size_t pieceFrom = piece * shorter.size();
+                Limbs pieceLimbs = SliceMagnitude(longer, pieceFrom, pieceFrom + shorter.size());
+                AddShiftedMagnitude(partialSum, MultiplyMagnitudes(pieceLimbs, shorter),
+                                    pieceFrom - firstPiece * shorter.size());
+            }
+            std::lock_guard lock(partialSumsMutex);
+            partialSums.emplace_back(firstPiece * shorter.size(), std::move(partialSum));
+        });
+
+        Limbs result;
+        for (auto const& [shift, partialSum] : partialSums) {
+            AddShiftedMagnitude(result, partialSum, shift);
+        }
+        return result;
+    }
+    if (shorter.size() < Toom3Threshold) {
+        return KaratsubaMultiply(longer, shorter);
+    }
+    if (shorter.size() >= FftThreshold && longer.size() + shorter.size() <= MaxFftLength) {
+        return FftMultiply(longer, shorter);
+    }
+    return Toom3Multiply(longer, shorter);
+}
+
+inline NumberString::Limbs NumberString::SchoolbookMultiply(Limbs const& first, Limbs const& second) {
+    if (first.empty() || second.empty()) {
+        return {};
+    }
+    Limbs result(first.size() + second.size());
+
+    for (size_t i = 0; i < first.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < second.size(); ++j) {
+            uint64_t current = result[i + j] + static_cast<uint64_t>(first[i]) * second[j] + carry;
+            result[i + j] = static_cast<Limb>(current % Base);
+            carry = current / Base;
+        }
+        result[i + second.size()] = static_cast<Limb>(carry);
+    }
+    TrimMagnitude(result);
+    return result;
+}
+
+inline NumberString::Limbs NumberString::KaratsubaMultiply(Limbs const& first, Limbs const& second) {
+    size_t half = (std::max(first.size(), second.size()) + 1) / 2;
+    Limbs firstLow = SliceMagnitude(first, 0, half), firstHigh = SliceMagnitude(first, half, first.size());
+    Limbs secondLow = SliceMagnitude(second, 0, half), secondHigh = SliceMagnitude(second, half, second.size());
+
+    Limbs lowProduct, highProduct, middleProduct;
+    RunParallel(second.size(),
+        [&] { lowProduct = MultiplyMagnitudes(firstLow, secondLow); },
+        [&] { highProduct = MultiplyMagnitudes(firstHigh, secondHigh); },
+        [&] {
+            Limbs firstSum = AddMagnitudes(firstLow, firstHigh), secondSum = AddMagnitudes(secondLow, secondHigh);
+            TrimMagnitude(firstSum); TrimMagnitude(secondSum);
+            middleProduct = MultiplyMagnitudes(firstSum, secondSum);
+        });
+    middleProduct = SubtractMagnitudes(middleProduct, lowProduct);
+    TrimMagnitude(middleProduct);
+    middleProduct = SubtractMagnitudes(middleProduct, highProduct);
+    TrimMagnitude(middleProduct);
+
+    Limbs result = std::move(lowProduct);
+    AddShiftedMagnitude(result, middleProduct, half);
+    AddShiftedMagnitude(result, highProduct, 2 * half);
+    return result;
+}
+
+inline NumberString::Limbs NumberString::Toom3Multiply(Limbs const& first, Limbs const& second) {
+    // Evaluation at 0, 1, -1, -2 and infinity with Bodrato's interpolation sequence.
+    // The intermediate values may be negative, so they are kept as signed NumberStrings.
+    size_t third = (std::max(first.size(), second.size()) + 2) / 3;
+    auto split = [third](Limbs const& magnitude, size_t index) {
+        NumberString part;
+        part.limbs = SliceMagnitude(magnitude, index * third, (index + 1) * third);
+        return part;
+    };
+    auto exactDivide = [](NumberString number, Limb divisor) {
+        [[maybe_unused]] Limb remainder = DivideSmall(number.limbs, divisor);
+        assert(remainder == 0);
+        number.RemoveTrailingZeros();
+        return number;
+    };
+
+    NumberString a0 = split(first, 0), a1 = split(first, 1), a2 = split(first, 2);
+    NumberString b0 = split(second, 0), b1 = split(second, 1), b2 = split(second, 2);
+
+    NumberString firstEven = a0 + a2, secondEven = b0 + b2;
+    NumberString firstAtOne = firstEven + a1, secondAtOne = secondEven + b1;
+    NumberString firstAtMinusOne = firstEven - a1, secondAtMinusOne = secondEven - b1;
+    NumberString firstAtMinusTwo = (firstAtMinusOne + a2) * 2 - a0;
+    NumberString secondAtMinusTwo = (secondAtMinusOne + b2) * 2 - b0;
+
+    NumberString r0, r1, rMinusOne, rMinusTwo, r4;
+    RunParallel(second.size(),
+        [&] { r0 = a0 * b0; },
+        [&] { r1 = firstAtOne * secondAtOne; },
+        [&] { rMinusOne = firstAtMinusOne * secondAtMinusOne; },
+        [&] { rMinusTwo = firstAtMinusTwo * secondAtMinusTwo; },
+        [&] { r4 = a2 * b2; });
+
+    NumberString r3 = exactDivide(rMinusTwo - r1, 3);
+    r1 = exactDivide(r1 - rMinusOne, 2);
+    NumberString r2 = rMinusOne - r0;
+    r3 = exactDivide(r2 - r3, 2) + r4 * 2;
+    r2 = r2 + r1 - r4;
+    r1 = r1 - r3;
+
+    Limbs result = std::move(r0.limbs);
+    AddShiftedMagnitude(result, r1.limbs, third);
+    AddShiftedMagnitude(result, r2.limbs, 2 * third);
+    AddShiftedMagnitude(result, r3.limbs, 3 * third);
+    AddShiftedMagnitude(result, r4.limbs, 4 * third);
+    return result;
+}
+
+namespace detail {
+
+constexpr uint32_t PowerModulo(uint64_t base, uint64_t exponent, uint32_t modulus) noexcept {
+    uint64_t result = 1;
+    for (base %= modulus; exponent != 0; exponent >>= 1, base = base * base % modulus) {
+        if (exponent & 1) result = result * base % modulus;
+    }
+    return static_cast<uint32_t>(result);
+}
+
+inline constexpr uint32_t FirstNttPrime = 998244353, SecondNttPrime = 167772161, ThirdNttPrime = 469762049;
+inline constexpr uint32_t NttPrimitiveRoot = 3;
+
+}  // namespace detail
+
+template<uint32_t Modulus, uint32_t PrimitiveRoot>
+void NumberString::NumberTheoreticTransform(std::vector<uint32_t>& values, bool isInverse) {
+    size_t length = values.size();
+    for (size_t i = 1, j = 0; i < length; ++i) {
+        size_t bit = length >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(values[i], values[j]);
+    }
+
+    // Powers of the length-th root of unity; a stage of size s uses every (length / s)-th one.
+    uint32_t root = detail::PowerModulo(PrimitiveRoot, (Modulus - 1) / length, Modulus);
+    if (isInverse) root = detail::PowerModulo(root, Modulus - 2, Modulus);
+    std::vector<uint32_t> roots(length / 2);
+    ParallelFor(roots.size(), [&](size_t from, size_t to) {
+        uint64_t power = detail::PowerModulo(root, from, Modulus);
+        for (size_t j = from; j < to; ++j, power = power * root % Modulus) {
+            roots[j] = static_cast<uint32_t>(power);
+        }
+    });
+
+    for (size_t stage = 2; stage <= length; stage <<= 1) {
+        size_t half = stage / 2, rootStride = length / stage;
+        auto butterflies = [&](size_t blockFrom, size_t blockTo, size_t pairFrom, size_t pairTo) {
+            for (size_t i = blockFrom * stage; i < blockTo * stage; i += stage) {
+                for (size_t j = pairFrom; j < pairTo; ++j) {
+                    uint32_t u = values[i + j];
+                    uint32_t v = static_cast<uint32_t>(
+                            static_cast<uint64_t>(values[i + j + half]) * roots[j * rootStride] % Modulus);
+                    values[i + j] = (u + v >= Modulus) ? u + v - Modulus : u + v;
+                    values[i + j + half] = (u >= v) ? u - v : u + Modulus - v;
+                }
+            }
+        };
+        // Early stages have many small blocks to share out, late stages a few long ones.
+        if (rootStride >= half) {
+            ParallelFor(rootStride, [&](size_t from, size_t to) { butterflies(from, to, 0, half); });
+        }
+        else {
+            ParallelFor(half, [&](size_t from, size_t to) { butterflies(0, rootStride, from, to); });
+        }
+    }
+
+    if (isInverse) {
+        uint64_t lengthInverse = detail::PowerModulo(length, Modulus - 2, Modulus);
+        ParallelFor(length, [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                values[i] = static_cast<uint32_t>(values[i] * lengthInverse % Modulus);
+            }
+        });
+    }
+}
+
+inline NumberString::Limbs NumberString::FftMultiply(Limbs const& first, Limbs const& second) {
+    using detail::FirstNttPrime, detail::SecondNttPrime, detail::ThirdNttPrime, detail::NttPrimitiveRoot;
+    using detail::PowerModulo;
+    size_t productLength = first.size() + second.size();
+    size_t transformLength = 1;
+    while (transformLength < productLength) transformLength <<= 1;
+    bool isSquaring = (first == second);
+
+    auto convolve = [&]<uint32_t Modulus>(std::integral_constant<uint32_t, Modulus>) {
+        std::vector<uint32_t> firstValues(transformLength);
+        std::transform(first.begin(), first.end(), firstValues.begin(),
+                       [](Limb limb) { return limb % Modulus; });
+        NumberTheoreticTransform<Modulus, NttPrimitiveRoot>(firstValues, false);
+
+        std::vector<uint32_t> secondValues;
+        if (!isSquaring) {
+            secondValues.resize(transformLength);
+            std::transform(second.begin(), second.end(), secondValues.begin(),
+                           [](Limb limb) { return limb % Modulus; });
+            NumberTheoreticTransform<Modulus, NttPrimitiveRoot>(secondValues, false);
+        }
+        std::vector<uint32_t> const& otherValues = isSquaring ? firstValues : secondValues;
+        ParallelFor(transformLength, [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                firstValues[i] = static_cast<uint32_t>(
+                        static_cast<uint64_t>(firstValues[i]) * otherValues[i] % Modulus);
+            }
+        });
+        NumberTheoreticTransform<Modulus, NttPrimitiveRoot>(firstValues, true);
+        return firstValues;
+    };
+    std::vector<uint32_t> firstResidues, secondResidues, thirdResidues;
+    RunParallel(transformLength,
+        [&] { firstResidues = convolve(std::integral_constant<uint32_t, FirstNttPrime>{}); },
+        [&] { secondResidues = convolve(std::integral_constant<uint32_t, SecondNttPrime>{}); },
+        [&] { thirdResidues = convolve(std::integral_constant<uint32_t, ThirdNttPrime>{}); });
+
+    // Garner's form of the CRT: coefficient = x1 + x2 * p1 + x3 * p1 * p2.
+    constexpr uint64_t firstInverseModSecond = PowerModulo(FirstNttPrime, SecondNttPrime - 2, SecondNttPrime);
+    constexpr uint64_t firstInverseModThird = PowerModulo(FirstNttPrime, ThirdNttPrime - 2, ThirdNttPrime);
+    constexpr uint64_t secondInverseModThird = PowerModulo(SecondNttPrime, ThirdNttPrime - 2, ThirdNttPrime);
+    constexpr uint64_t firstTimesSecond = static_cast<uint64_t>(FirstNttPrime) * SecondNttPrime;
+
+    Limbs result(productLength);
+    unsigned __int128 carry = 0;
+    for (size_t i = 0; i < productLength; ++i) {
+        uint64_t x1 = firstResidues[i];
+        uint64_t x2 = (secondResidues[i] + SecondNttPrime - x1 % SecondNttPrime)
+                      * firstInverseModSecond % SecondNttPrime;
+        uint64_t x3 = (thirdResidues[i] + ThirdNttPrime - x1 % ThirdNttPrime)
+                      * firstInverseModThird % ThirdNttPrime;
+        x3 = (x3 + ThirdNttPrime - x2) * secondInverseModThird % ThirdNttPrime;
+
+        carry += x1 + x2 * FirstNttPrime + static_cast<unsigned __int128>(x3) * firstTimesSecond;
+        result[i] = static_cast<Limb>(carry % Base);
+        carry /= Base;
+    }
+    assert(carry == 0);
+    TrimMagnitude(result);
+    return result;
+}
+
+inline void NumberString::MultiplyAddSmall(Limbs& magnitude, Limb multiplier, Limb addend) {
+    uint64_t carry = addend;
+    for (Limb& limb : magnitude) {
+        uint64_t current = static_cast<uint64_t>(limb) * multiplier + carry;
+        limb = static_cast<Limb>(current % Base);
+        carry = current / Base;
+    }
+    if (carry != 0) magnitude.push_back(static_cast<Limb>(carry));
+}
+
+inline NumberString::Limb NumberString::DivideSmall(Limbs& magnitude, Limb divisor) noexcept {
+    uint64_t remainder = 0;
+    for (size_t i = magnitude.size(); i-- > 0; ) {
+        uint64_t current = remainder * Base + magnitude[i];
+        magnitude[i] = static_cast<Limb>(current / divisor);
+        remainder = current % divisor;
+    }
+    return static_cast<Limb>(remainder);
+}
+
+inline void NumberString::DivideMagnitudes(Limbs const& dividend, Limbs const& divisor,
+                                           Limbs& quotient, Limbs& remainder) {
+    assert(!divisor.empty());
+    if (CompareMagnitudes(dividend, divisor) < 0) {
+        quotient.clear();
+        remainder = dividend;
+    }
+    else if (divisor.size() == 1) {
+        quotient = dividend;
+        Limb smallRemainder = DivideSmall(quotient, divisor.front());
+        TrimMagnitude(quotient);
+        remainder.assign(smallRemainder != 0, smallRemainder);
+    }
+    else if (divisor.size() < NewtonDivisionThreshold
+             || dividend.size() - divisor.size() < NewtonDivisionThreshold) {
+        KnuthDivide(dividend, divisor, quotient, remainder);
+    }
+    else {
+        NewtonDivide(dividend, divisor, ReciprocalMagnitude(divisor), quotient, remainder);
+    }
+}
+
+inline void NumberString::KnuthDivide(Limbs const& dividend, Limbs const& divisor,
+                                      Limbs& quotient, Limbs& remainder) {
+    Limb scale = Base / (divisor.back() + 1);
+    Limbs normalizedDivisor = divisor;
+    MultiplyAddSmall(normalizedDivisor, scale, 0);
+    KnuthDivide(dividend, normalizedDivisor, scale, quotient, remainder);
+}
+
+inline void NumberString::KnuthDivide(Limbs const& dividend, Limbs const& normalizedDivisor, Limb scale,
+                                      Limbs& quotient, Limbs& remainder) {
+    // Algorithm D from TAOCP 4.3.1: scaling makes the top divisor limb at least
+    // Base / 2, so every estimated quotient limb is at most two units too large.
+    size_t divisorLength = normalizedDivisor.size(), quotientLength = dividend.size() - divisorLength + 1;
+
+    Limbs work = dividend;
+    MultiplyAddSmall(work, scale, 0);
+    work.resize(dividend.size() + 1);
+    uint64_t topLimb = normalizedDivisor[divisorLength - 1], nextLimb = normalizedDivisor[divisorLength - 2];
+
+    quotient.assign(quotientLength, 0);
+    for (size_t j = quotientLength; j-- > 0; ) {
+        uint64_t numerator = work[j + divisorLength] * static_cast<uint64_t>(Base) + work[j + divisorLength - 1];
+        uint64_t estimate = numerator / topLimb, estimateRemainder = numerator % topLimb;
+        while (estimate >= Base
+               || estimate * nextLimb > estimateRemainder * Base + work[j + divisorLength - 2]) {
+            --estimate;
+            estimateRemainder += topLimb;
+            if (estimateRemainder >= Base) break;
+        }
+
+        uint64_t carry = 0;
+        int64_t borrow = 0;
+        for (size_t i = 0; i < divisorLength; ++i) {
+            uint64_t product = estimate * normalizedDivisor[i] + carry;
+            carry = product / Base;
+            int64_t difference = static_cast<int64_t>(work[i + j]) - static_cast<int64_t>(product % Base) - borrow;
+            borrow = (difference < 0);
+            work[i + j] = static_cast<Limb>(borrow ? difference + Base : difference);
+        }
+        int64_t top = static_cast<int64_t>(work[j + divisorLength]) - static_cast<int64_t>(carry) - borrow;
+
+        if (top < 0) {
+            --estimate;
+            Limb addCarry = 0;
+            for (size_t i = 0; i < divisorLength; ++i) {
+                Limb sum = work[i + j] + normalizedDivisor[i] + addCarry;
+                addCarry = (sum >= Base);
+                work[i + j] = addCarry ? sum - Base : sum;
+            }
+            top += addCarry;
+        }
+        work[j + divisorLength] = static_cast<Limb>(top);
+        quotient[j] = static_cast<Limb>(estimate);
+    }
+
+    work.resize(divisorLength);
+    DivideSmall(work, scale);
+    TrimMagnitude(work);
+    TrimMagnitude(quotient);
+    remainder = std::move(work);
+}
+
+inline NumberString::Limbs NumberString::ReciprocalMagnitude(Limbs const& divisor) {
+    // Returns floor(Base^(2n) / divisor) for an n-limb divisor. The top half of the
+    // divisor is inverted recursively and one Newton step x + x * (1 - d * x)
+    // doubles the precision; the last few units are fixed by an exact correction.
+    size_t divisorLength = divisor.size();
+    Limbs power(2 * divisorLength + 1, 0);
+    power.back() = 1;
+    if (divisorLength <= 4 || divisorLength < NewtonDivisionThreshold) {
+        Limbs reciprocal, unused;
+        KnuthDivide(power, divisor, reciprocal, unused);
+        return reciprocal;
+    }
+
+    size_t highLength = divisorLength / 2 + 2;
+    NumberString approximation, divisorNumber, powerNumber;
+    approximation.limbs.assign(divisorLength - highLength, 0);
+    Limbs highReciprocal = ReciprocalMagnitude(SliceMagnitude(divisor, divisorLength - highLength, divisorLength));
+    approximation.limbs.insert(approximation.limbs.end(), highReciprocal.begin(), highReciprocal.end());
+    divisorNumber.limbs = divisor;
+    powerNumber.limbs = std::move(power);
+
+    NumberString error = powerNumber - divisorNumber * approximation;
+    NumberString step = approximation * error;
+    step.limbs = SliceMagnitude(step.limbs, 2 * divisorLength, step.limbs.size());
+    step.RemoveTrailingZeros();
+    approximation += step;
+
+    auto [correction, residual] = DivMod(powerNumber - divisorNumber * approximation, divisorNumber);
+    if (residual.isNegative) correction -= 1;
+    approximation += correction;
+    return approximation.limbs;
+}
+
+inline void NumberString::NewtonDivide(Limbs const& dividend, Limbs const& divisor, Limbs const& reciprocal,
+                                       Limbs& quotient, Limbs& remainder) {
+    // The dividend is consumed in blocks of n limbs from the top, so every partial
+    // dividend stays below Base^(2n) and is divided by one Barrett step with
+    // reciprocal = floor(Base^(2n) / divisor).
+    size_t blockLength = divisor.size();
+    Limbs partial, blockQuotient;
+
+    quotient.assign(dividend.size(), 0);
+    remainder.clear();
+    for (size_t block = (dividend.size() + blockLength - 1) / blockLength; block-- > 0; ) {
+        size_t from = block * blockLength, to = std::min(from + blockLength, dividend.size());
+        partial.assign(dividend.begin() + from, dividend.begin() + to);
+        partial.resize(blockLength, 0);
+        partial.insert(partial.end(), remainder.begin(), remainder.end());
+        TrimMagnitude(partial);
+
+        BarrettDivide(partial, divisor, reciprocal, blockQuotient, remainder);
+        std::copy(blockQuotient.begin(), blockQuotient.end(), quotient.begin() + from);
+    }
+    TrimMagnitude(quotient);
+}
+
+inline void NumberString::BarrettDivide(Limbs const& value, Limbs const& modulus, Limbs const& reciprocal,
+                                        Limbs& quotient, Limbs& remainder) {
+    // Divides a value below Base^(2n) by an n-limb modulus, given
+    // reciprocal = floor(Base^(2n) / modulus); the estimate is at most two short.
+    size_t modulusLength = modulus.size();
+    assert(value.size() <= 2 * modulusLength);
+    if (value.size() < modulusLength) {
+        quotient.clear();
+        remainder = value;
+        return;
+    }
+    quotient = MultiplyMagnitudes(SliceMagnitude(value, modulusLength - 1, value.size()), reciprocal);
+    quotient = SliceMagnitude(quotient, modulusLength + 1, quotient.size());
+    TrimMagnitude(quotient);
+
+    remainder = SubtractMagnitudes(value, MultiplyMagnitudes(quotient, modulus));
+    TrimMagnitude(remainder);
+    while (CompareMagnitudes(remainder, modulus) >= 0) {
+        SubtractMagnitudeInPlace(remainder, modulus);
+        TrimMagnitude(remainder);
+        MultiplyAddSmall(quotient, 1, 1);
+    }
+}
+
+inline std::vector<bool> NumberString::ToBinaryDigits(Limbs magnitude) {
+    constexpr size_t chunkBits = 30;
+    std::vector<bool> bits;
+    for (TrimMagnitude(magnitude); !magnitude.empty(); TrimMagnitude(magnitude)) {
+        Limb chunk = DivideSmall(magnitude, Limb{ 1 } << chunkBits);
+        for (size_t i = 0; i < chunkBits; ++i, chunk >>= 1) {
+            bits.push_back(chunk & 1);
+        }
+    }
+    while (!bits.empty() && !bits.back()) {
+        bits.pop_back();
+    }
+    return bits;
+}
+
+template<class Multiply>
+NumberString NumberString::SlidingWindowPower(NumberString const& base, NumberString const& exponent,
+                                              Multiply multiply) {
+    // Left-to-right sliding window over the binary exponent: one squaring per bit
+    // plus one multiplication by a precomputed odd power per window.
+    std::vector<bool> bits = ToBinaryDigits(exponent.limbs);
+    size_t windowBits = (bits.size() <= 8) ? 1 : (bits.size() <= 64) ? 3 : (bits.size() <= 512) ? 4 : 5;
+
+    std::vector<NumberString> oddPowers{ base };
+    if (windowBits > 1) {
+        NumberString baseSquared = multiply(base, base);
+        for (size_t i = 1; i < (size_t{ 1 } << (windowBits - 1)); ++i) {
+            oddPowers.push_back(multiply(oddPowers.back(), baseSquared));
+        }
+    }
+
+    NumberString result = 1;
+    for (size_t i = bits.size(); i-- > 0; ) {
+        if (!bits[i]) {
+            result = multiply(result, result);
+            continue;
+        }
+        size_t windowEnd = (i + 1 >= windowBits) ? i + 1 - windowBits : 0;
+        while (!bits[windowEnd]) ++windowEnd;
+
+        size_t windowValue = 0;
+        for (size_t j = i + 1; j-- > windowEnd; ) {
+            result = multiply(result, result);
+            windowValue = (windowValue << 1) | bits[j];
+        }
+        result = multiply(result, oddPowers[windowValue >> 1]);
+        i = windowEnd;
+    }
+    return result;
+}
+
+inline bool NumberString::TryGetUnsigned(Limbs const& magnitude, unsigned long long& value) noexcept {
+    constexpr unsigned long long maxValue = ~0ull;
+    value = 0;
+    for (size_t i = magnitude.size(); i-- > 0; ) {
+        if (value > (maxValue - magnitude[i]) / Base) {
+            return false;
+        }
+        value = value * Base + magnitude[i];
+    }
+    return true;
+}
+
+inline std::vector<uint32_t> NumberString::SievePrimes(uint32_t limit) {
+    std::vector<uint32_t> primes;
+    if (limit < 2) {
+        return primes;
+    }
+
+    // Only odd numbers are sieved: index i stands for 2 * i + 1.
+    std::vector<bool> isComposite(limit / 2 + 1, false);
+    primes.push_back(2);
+    for (uint64_t i = 1; 2 * i + 1 <= limit; ++i) {
+        if (isComposite[i]) continue;
+        uint64_t prime = 2 * i + 1;
+        primes.push_back(static_cast<uint32_t>(prime));
+        for (uint64_t multiple = prime * prime; multiple <= limit; multiple += 2 * prime) {
+            isComposite[multiple / 2] = true;
+        }
+    }
+    return primes;
+}
+
+template<class Factor>
+NumberString NumberString::ProductTree(std::vector<Factor> const& factors, size_t from, size_t to) {
+    // Splitting the range in halves keeps both operands of every multiplication of
+    // similar size, which is what the Karatsuba, Toom-3 and NTT tiers need.
+    constexpr size_t leafLength = 16;
+    if (to - from <= leafLength) {
+        NumberString product = 1;
+        for (size_t i = from; i < to; ++i) {
+            product *= NumberString(factors[i]);
+        }
+        return product;
+    }
+    size_t middle = from + (to - from) / 2;
+    return ProductTree(factors, from, middle) * ProductTree(factors, middle, to);
+}
+
+inline NumberString NumberString::PrimeSwingFactorial(uint32_t n, std::vector<uint32_t> const& primes) {
+    // n! = ((n / 2)!)^2 * swing(n), where the swinging factorial n! / ((n / 2)!)^2
+    // has a prime p with exponent equal to the number of odd values floor(n / p^i).
+    if (n < 2) {
+        return 1;
+    }
+    NumberString halfFactorial = PrimeSwingFactorial(n / 2, primes);
+
+    std::vector<unsigned long long> swingFactors;
+    for (uint32_t prime : primes) {
+        if (prime > n) break;
+        unsigned long long primePower = 1;
+        for (uint32_t quotient = n / prime; quotient != 0; quotient /= prime) {
+            if (quotient & 1) primePower *= prime;
+        }
+        if (primePower > 1) swingFactors.push_back(primePower);
+    }
+    return halfFactorial * halfFactorial * ProductTree(swingFactors, 0, swingFactors.size());
+}
+
+inline bool NumberString::SubtractMagnitudeInPlace(Limbs& accumulator, Limbs const& subtrahend) {
+    // Stores |accumulator - subtrahend| and reports whether the difference changed sign.
+    if (CompareMagnitudes(accumulator, subtrahend) < 0) {
+        accumulator.resize(subtrahend.size());
+        SubtractLimbs(accumulator.data(), subtrahend.data(), accumulator.data(), subtrahend.size());
+        return true;
+    }
+
+    Limb borrow = SubtractLimbs(accumulator.data(), accumulator.data(), subtrahend.data(), subtrahend.size());
+    for (size_t i = subtrahend.size(); borrow != 0; ++i) {
+        borrow = (accumulator[i] == 0);
+        accumulator[i] = borrow ? Base - 1 : accumulator[i] - 1;
+    }
+    return false;
+}
+
+inline unsigned __int128 NumberString::NativeMagnitude(Limbs const& magnitude) noexcept {
+    assert(magnitude.size() <= NativeLimbs);
+    unsigned __int128 value = 0;
+    for (size_t i = magnitude.size(); i-- > 0; ) {
+        value = value * Base + magnitude[i];
+    }
+    return value;
+}
+
+inline void NumberString::AssignNative(__int128 value) noexcept {
+    isNegative = value < 0;
+    unsigned __int128 magnitude = isNegative ? 0 - static_cast<unsigned __int128>(value)
+                                             : static_cast<unsigned __int128>(value);
+    limbs.clear();
+    for (; magnitude > UINT64_MAX; magnitude /= Base) {
+        limbs.push_back(static_cast<Limb>(magnitude % Base));
+    }
+    for (auto low = static_cast<uint64_t>(magnitude); low != 0; low /= Base) {
+        limbs.push_back(static_cast<Limb>(low % Base));
+    }
+}
+
+inline NumberString& NumberString::AddInPlace(Limbs const& magnitude, bool isMagnitudeNegative) {
+    if (FitsNative() && magnitude.size() <= NativeLimbs) {
+        auto other = static_cast<__int128>(NativeMagnitude(magnitude));
+        AssignNative(ToNative() + (isMagnitudeNegative ? -other : other));
+        return *this;
+    }
+    if (this->isNegative == isMagnitudeNegative) {
+        AddShiftedMagnitude(limbs, magnitude, 0);
+    }
+    else if (SubtractMagnitudeInPlace(limbs, magnitude)) {
+        isNegative = isMagnitudeNegative;
+    }
+    RemoveTrailingZeros();
+    return *this;
+}
+
+inline NumberString NumberString::FusedSum(SignedTerms const& terms) {
+    NumberString result;
+    bool fitsNative = true;
+    for (SignedTerm const& term : terms) {
+        fitsNative = fitsNative && term.magnitude->size() <= NativeLimbs;
+    }
+    if (fitsNative) {
+        __int128 sum = 0;
+        bool isOverflow = false;
+        for (SignedTerm const& term : terms) {
+            auto value = static_cast<__int128>(NativeMagnitude(*term.magnitude));
+            isOverflow |= term.isNegative ? __builtin_sub_overflow(sum, value, &sum)
+                                          : __builtin_add_overflow(sum, value, &sum);
+        }
+        if (!isOverflow) {
+            result.AssignNative(sum);
+            return result;
+        }
+    }
+
+    if (terms.empty()) {
+        return result;
+    }
+
+    // The longest term seeds the sum modulo Base^length, and the others are added or
+    // subtracted onto it a block at a time, so each block of the sum stays in cache
+    // while every term passes over it. A term hands its carry or borrow on to its own
+    // next block, and once the term ends that is rippled through the sum. Fewer than
+    // Base terms stay below Base^length, so the sum wraps past the top limb only when
+    // it comes out negative, in which case the complement is its magnitude.
+    SignedTerm const* longest = &terms.front();
+    for (SignedTerm const& term : terms) {
+        if (term.magnitude->size() > longest->magnitude->size()) {
+            longest = &term;
+        }
+    }
+    size_t length = longest->magnitude->size() + 1;
+    result.limbs.reserve(length);
+    result.limbs.assign(longest->magnitude->begin(), longest->magnitude->end());
+    result.limbs.push_back(0);
+    Limb* sum = result.limbs.data();
+
+    constexpr size_t BlockLength = 1024;
+    SmallVector<Limb, 8> carries(terms.size());
+    int wraps = 0;
+    for (size_t blockFrom = 0; blockFrom + 1 < length; blockFrom += BlockLength) {
+        for (size_t t = 0; t < terms.size(); ++t) {
+            Limbs const& magnitude = *terms[t].magnitude;
+            if (&terms[t] == longest || magnitude.size() <= blockFrom) {
+                continue;
+            }
+            size_t count = std::min(BlockLength, magnitude.size() - blockFrom);
+            bool isSubtracted = terms[t].isNegative != longest->isNegative;
+            Limb carry = isSubtracted
+                    ? SubtractLimbs(sum + blockFrom, sum + blockFrom, magnitude.data() + blockFrom, count, carries[t])
+                    : AddLimbs(sum + blockFrom, sum + blockFrom, magnitude.data() + blockFrom, count, carries[t]);
+            if (blockFrom + count == magnitude.size()) {
+                for (size_t position = magnitude.size(); carry != 0 && position < length; ++position) {
+                    Limb limb = sum[position];
+                    carry = isSubtracted ? (limb == 0) : (limb == Base - 1);
+                    sum[position] = isSubtracted ? (carry ? Base - 1 : limb - 1) : (carry ? 0 : limb + 1);
+                }
+                wraps += isSubtracted ? -static_cast<int>(carry) : static_cast<int>(carry);
+                carry = 0;
+            }
+            carries[t] = carry;
+        }
+    }
+
+    result.isNegative = longest->isNegative;
+    if (wraps < 0) {
+        Limb borrow = 0;
+        for (Limb& limb : result.limbs) {
+            Limb subtrahend = limb + borrow;
+            borrow = (subtrahend != 0);
+            limb = borrow ? Base - subtrahend : 0;
+        }
+        result.isNegative = !result.isNegative;
+    }
+    result.RemoveTrailingZeros();
+    return result;
+}
+
+inline NumberString& NumberString::MultiplyAccumulate(NumberString const& first, NumberString const& second,
+                                                      bool isNegated) {
+    bool isProductNegative = (first.isNegative != second.isNegative) != isNegated;
+    __int128 nativeProduct, nativeSum;
+    if (FitsNative() && first.FitsNative() && second.FitsNative()
+        && !__builtin_mul_overflow(first.ToNative(), second.ToNative(), &nativeProduct)
+        && !(isNegated ? __builtin_sub_overflow(ToNative(), nativeProduct, &nativeSum)
+                       : __builtin_add_overflow(ToNative(), nativeProduct, &nativeSum))) {
+        AssignNative(nativeSum);
+        return *this;
+    }
+
+    Limbs const& longer = (first.limbs.size() >= second.limbs.size()) ? first.limbs : second.limbs;
+    Limbs const& shorter = (first.limbs.size() >= second.limbs.size()) ? second.limbs : first.limbs;
+    if (shorter.empty()) {
+        return *this;
+    }
+    // Only a product of schoolbook size with the accumulator's sign, and which does
+    // not read the accumulator itself, is summed into its limbs row by row.
+    bool isAliased = (&first == this || &second == this);
+    if (isAliased || shorter.size() >= KaratsubaThreshold || (!IsZero() && isNegative != isProductNegative)) {
+        return AddInPlace(MultiplyMagnitudes(longer, shorter), isProductNegative);
+    }
+
+    limbs.resize(std::max(limbs.size(), longer.size() + shorter.size()) + 1);
+    for (size_t i = 0; i < shorter.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < longer.size(); ++j) {
+            uint64_t current = limbs[i + j] + static_cast<uint64_t>(shorter[i]) * longer[j] + carry;
+            limbs[i + j] = static_cast<Limb>(current % Base);
+            carry = current / Base;
+        }
+        for (size_t position = i + longer.size(); carry != 0; ++position) {
+            uint64_t current = limbs[position] + carry;
+            limbs[position] = static_cast<Limb>(current % Base);
+            carry = current / Base;
+        }
+    }
+    isNegative = isProductNegative;
+    RemoveTrailingZeros();
+    return *this;
+}
+
+inline NumberString NumberString::RootMagnitude(Limbs const& magnitude, unsigned degree) {
+    // Newton's iteration x <- ((k - 1) x + n / x^(k - 1)) / k decreases monotonically
+    // to floor(n^(1/k)) from any start above it. The start is the root of the top
+    // part of n, which is already correct to about half the limbs of the result, so
+    // the full-length iteration only runs a couple of times.
+    NumberString value;
+    value.limbs = magnitude;
+    if (magnitude.empty() || degree == 1) {
+        return value;
+    }
+
+    NumberString root;
+    size_t shift = magnitude.size() / (2 * static_cast<size_t>(degree));
+    if (shift == 0) {
+        // The root is below Base^2, so a floating-point estimate with a safety
+        // margin is close enough.
+        size_t topLength = std::min<size_t>(magnitude.size(), 3);
+        long double top = 0;
+        for (size_t i = magnitude.size(); i-- > magnitude.size() - topLength; ) {
+            top = top * Base + magnitude[i];
+        }
+        long double logValue = std::log(top) + (magnitude.size() - topLength) * std::log(static_cast<long double>(Base));
+        long double estimate = std::exp(logValue / degree) * (1 + 1e-9L) + 2;
+        root = static_cast<long long>(std::min(estimate, 2e18L));
+    }
+    else {
+        root = RootMagnitude(SliceMagnitude(magnitude, degree * shift, magnitude.size()), degree) + 1ll;
+        Limbs lowZeros(shift);
+        root.limbs.insert(root.limbs.begin(), lowZeros.begin(), lowZeros.end());
+    }
+
+    NumberString degreeNumber = static_cast<long long>(degree), lowerDegree = static_cast<long long>(degree - 1);
+    for (;;) {
+        NumberString next = (lowerDegree * root + value / (root ^ lowerDegree)) / degreeNumber;
+        if (next >= root) {
+            return root;
+        }
+        root = std::move(next);
+    }
+}
+
+inline void NumberString::ReduceGcd(NumberString& first, NumberString& second, size_t targetLength, GcdMatrix* matrix) {
+    // Runs Euclid on first >= second >= 0 until second has at most targetLength limbs,
+    // folding every step into matrix when one is given. Long balanced operands first
+    // run this recursively on their top halves, which yields the quotients of about
+    // a quarter of the full length at the cost of a few big multiplications.
+    while (second.limbs.size() > targetLength) {
+        if (targetLength == 0 && !matrix && first.FitsNative()) {
+            unsigned __int128 greater = NativeMagnitude(first.limbs), lesser = NativeMagnitude(second.limbs);
+            while (lesser != 0) {
+                greater = std::exchange(lesser, greater % lesser);
+            }
+            first.AssignNative(static_cast<__int128>(greater));
+            second = NumberString{};
+            return;
+        }
+
+        size_t length = first.limbs.size();
+        if (length >= HalfGcdThreshold && length - second.limbs.size() <= 1) {
+            size_t shift = length / 2;
+            NumberString firstTop, secondTop;
+            firstTop.limbs = SliceMagnitude(first.limbs, shift, length);
+            secondTop.limbs = SliceMagnitude(second.limbs, shift, length);
+            GcdMatrix reduction;
+            ReduceGcd(firstTop, secondTop, (length - shift) / 2 + 1, &reduction);
+            ApplyGcdMatrix(std::move(reduction), first, second, matrix);
+            if (second.limbs.size() <= targetLength) {
+                break;
+            }
+        }
+        LehmerStep(first, second, matrix);
+    }
+}
+
+inline void NumberString::LehmerStep(NumberString& first, NumberString& second, GcdMatrix* matrix) {
+    // Knuth's Algorithm L: Euclid runs on the leading two limbs of both operands for
+    // as long as the quotients provably agree with those of the full operands, and
+    // the collected single-precision cofactors are then applied in one pass. When
+    // not even one quotient is certain, a full division step is taken instead.
+    size_t length = first.limbs.size();
+    auto leading = [length](NumberString const& number) {
+        int64_t value = 0;
+        for (size_t i = length; i-- > length - std::min<size_t>(length, 2); ) {
+            value = value * Base + (i < number.limbs.size() ? number.limbs[i] : 0);
+        }
+        return value;
+    };
+    int64_t firstLeading = leading(first), secondLeading = leading(second);
+    int64_t topLeft = 1, topRight = 0, bottomLeft = 0, bottomRight = 1;
+    while (secondLeading + bottomLeft != 0 && secondLeading + bottomRight != 0) {
+        int64_t quotient = (firstLeading + topLeft) / (secondLeading + bottomLeft);
+        if (quotient != (firstLeading + topRight) / (secondLeading + bottomRight)) {
+            break;
+        }
+        topLeft = std::exchange(bottomLeft, topLeft - quotient * bottomLeft);
+        topRight = std::exchange(bottomRight, topRight - quotient * bottomRight);
+        firstLeading = std::exchange(secondLeading, firstLeading - quotient * secondLeading);
+    }
+
+    if (topRight != 0) {
+        ApplyGcdMatrix({ topLeft, topRight, bottomLeft, bottomRight }, first, second, matrix);
+        return;
+    }
+    auto [quotient, remainder] = DivMod(first, second);
+    first = std::exchange(second, std::move(remainder));
+    if (matrix) {
+        matrix->topLeft = std::exchange(matrix->bottomLeft, matrix->topLeft - quotient * matrix->bottomLeft);
+        matrix->topRight = std::exchange(matrix->bottomRight, matrix->topRight - quotient * matrix->bottomRight);
+    }
+}
+
+inline void NumberString::ApplyGcdMatrix(GcdMatrix step, NumberString& first, NumberString& second, GcdMatrix* matrix) {
+    // Any unimodular step keeps the GCD. A step taken from truncated operands may
+    // overshoot, so its rows are negated or swapped to keep first >= second >= 0.
+    NumberString newFirst = step.topLeft * first + step.topRight * second;
+    NumberString newSecond = step.bottomLeft * first + step.bottomRight * second;
+    auto negate = [](NumberString& number) {
+        if (!number.IsZero()) number.isNegative = !number.isNegative;
+    };
+    if (newFirst.isNegative) {
+        negate(newFirst), negate(step.topLeft), negate(step.topRight);
+    }
+    if (newSecond.isNegative) {
+        negate(newSecond), negate(step.bottomLeft), negate(step.bottomRight);
+    }
+    if (newFirst < newSecond) {
+        std::swap(newFirst, newSecond);
+        std::swap(step.topLeft, step.bottomLeft);
+        std::swap(step.topRight, step.bottomRight);
+    }
+    first = std::move(newFirst);
+    second = std::move(newSecond);
+    if (matrix) {
+        *matrix = {
+            step.topLeft * matrix->topLeft + step.topRight * matrix->bottomLeft,
+            step.topLeft * matrix->topRight + step.topRight * matrix->bottomRight,
+            step.bottomLeft * matrix->topLeft + step.bottomRight * matrix->bottomLeft,
+            step.bottomLeft * matrix->topRight + step.bottomRight * matrix->bottomRight
+        };
+    }
+}
+
+inline void NumberString::TrimMagnitude(Limbs& magnitude) noexcept {
+    while (!magnitude.empty() && magnitude.back() == 0) {
+        magnitude.pop_back();
+    }
+}
+
+inline NumberString::Limbs NumberString::SliceMagnitude(Limbs const& magnitude, size_t from, size_t to) {
+    from = std::min(from, magnitude.size());
+    to = std::min(std::max(from, to), magnitude.size());
+    Limbs slice(magnitude.begin() + from, magnitude.begin() + to);
+    TrimMagnitude(slice);
+    return slice;
+}
+
+inline void NumberString::AddShiftedMagnitude(Limbs& accumulator, Limbs const& addend, size_t shift) {
+    if (addend.empty()) {
+        return;
+    }
+    if (accumulator.size() < addend.size() + shift) {
+        accumulator.resize(addend.size() + shift);
+    }
+
+    Limb carry = AddLimbs(accumulator.data() + shift, accumulator.data() + shift, addend.data(), addend.size());
+    for (size_t position = shift + addend.size(); carry != 0; ++position) {
+        if (position == accumulator.size()) {
+            accumulator.push_back(0);
+        }
+        Limb sum = accumulator[position] + carry;
+        carry = (sum >= Base);
+        accumulator[position] = carry ? sum - Base : sum;
+    }
+}
+
+
+inline NumberString operator+ (NumberString const& firstNum, NumberString const& secondNum) {
+    NumberString result;
+    result.limbs.reserve(std::max(firstNum.limbs.size(), secondNum.limbs.size()) + 1);
+    result.limbs = firstNum.limbs;
+    result.isNegative = firstNum.isNegative;
+    result += secondNum;
+    return result;
+}
+
+inline NumberString operator+ (NumberString&& firstNum, NumberString const& secondNum) {
+    return std::move(firstNum += secondNum);
+}
+
+inline NumberString operator+ (NumberString const& firstNum, NumberString&& secondNum) {
+    return std::move(secondNum += firstNum);
+}
+
+inline NumberString operator+ (NumberString&& firstNum, NumberString&& secondNum) {
+    return std::move(firstNum += secondNum);
+}
+
+inline NumberString operator- (NumberString const& firstNum, NumberString const& secondNum) {
+    NumberString result;
+    result.limbs.reserve(std::max(firstNum.limbs.size(), secondNum.limbs.size()) + 1);
+    result.limbs = firstNum.limbs;
+    result.isNegative = firstNum.isNegative;
+    result -= secondNum;
+    return result;
+}
+
+inline NumberString operator- (NumberString&& firstNum, NumberString const& secondNum) {
+    return std::move(firstNum -= secondNum);
+}
+
+inline NumberString operator- (NumberString const& firstNum, NumberString&& secondNum) {
+    secondNum.isNegative = !secondNum.isNegative;
+    secondNum += firstNum;
+    return std::move(secondNum);
+}
+
+inline NumberString operator- (NumberString&& firstNum, NumberString&& secondNum) {
+    return std::move(firstNum -= secondNum);
+}
+
+inline NumberString operator* (NumberString const& firstNum, NumberString const& secondNum) {
+    NumberString result;
+    __int128 nativeProduct;
+    if (firstNum.FitsNative() && secondNum.FitsNative()
+        && !__builtin_mul_overflow(firstNum.ToNative(), secondNum.ToNative(), &nativeProduct)) {
+        result.AssignNative(nativeProduct);
+        return result;
+    }
+    result.limbs = NumberString::MultiplyMagnitudes(firstNum.limbs, secondNum.limbs);
+    result.isNegative = firstNum.isNegative != secondNum.isNegative;
+    result.RemoveTrailingZeros();
+    return result;
+}
+
+inline NumberString operator* (NumberString&& firstNum, NumberString const& secondNum) {
+    return std::move(firstNum *= secondNum);
+}
+
+inline NumberString operator/ (NumberString const& firstNum, NumberString const& secondNum) {
+    return DivMod(firstNum, secondNum).first;
+}
+
+inline NumberString operator/ (NumberString&& firstNum, NumberString const& secondNum) {
+    return std::move(firstNum /= secondNum);
+}
+
+inline NumberString operator% (const NumberString& firstNum, const NumberString& secondNum) {
+    return DivMod(firstNum, secondNum).second;
+}
+
+inline std::pair<NumberString, NumberString> DivMod(NumberString const& dividend, NumberString const& divisor) {
+    if (divisor.IsZero()) {
+        throw std::overflow_error("Division by zero exception");
+    }
+
+    NumberString quotient, remainder;
+    if (dividend.FitsNative() && divisor.FitsNative()) {
+        quotient.AssignNative(dividend.ToNative() / divisor.ToNative());
+        remainder.AssignNative(dividend.ToNative() % divisor.ToNative());
+        return { quotient, remainder };
+    }
+    NumberString::DivideMagnitudes(dividend.limbs, divisor.limbs, quotient.limbs, remainder.limbs);
+    quotient.isNegative = dividend.isNegative != divisor.isNegative;
+    remainder.isNegative = dividend.isNegative;
+    quotient.RemoveTrailingZeros();
+    remainder.RemoveTrailingZeros();
+    return { quotient, remainder };
+}
+
+inline NumberString operator^ (const NumberString& number, const NumberString& power) {
+    if (power.isNegative) {
+        throw std::domain_error("Negative powers of NumberString are not supported");
+    }
+    return NumberString::SlidingWindowPower(number, power,
+        [](NumberString const& first, NumberString const& second) { return first * second; });
+}
+
+inline NumberString PowMod(NumberString const& base, NumberString const& exponent, NumberString const& modulus) {
+    if (modulus.IsZero()) {
+        throw std::overflow_error("Division by zero exception");
+    }
+    if (exponent.isNegative) {
+        throw std::domain_error("Negative powers of NumberString are not supported");
+    }
+
+    NumberString positiveModulus = modulus;
+    positiveModulus.isNegative = false;
+    NumberString reducedBase = base % positiveModulus;
+    if (reducedBase.isNegative) reducedBase += positiveModulus;
+
+    Divisor reducer(positiveModulus);
+    NumberString result = NumberString::SlidingWindowPower(reducedBase, exponent,
+        [&](NumberString const& first, NumberString const& second) { return first * second % reducer; });
+    return result % reducer;
+}
+
+inline NumberString operator! (const NumberString& number) {
+    if (number.isNegative) {
+        throw std::domain_error("Factorial of a negative NumberString is undefined");
+    }
+    unsigned long long n;
+    if (!NumberString::TryGetUnsigned(number.limbs, n) || n > NumberString::MaxSieveLimit) {
+        throw std::length_error("NumberString factorial argument is too large");
+    }
+    return NumberString::PrimeSwingFactorial(static_cast<uint32_t>(n),
+                                             NumberString::SievePrimes(static_cast<uint32_t>(n)));
+}
+
+inline NumberString Binomial(NumberString const& n, NumberString const& k) {
+    if (n.isNegative) {
+        throw std::domain_error("Binomial coefficient of a negative NumberString is undefined");
+    }
+    if (k.isNegative || k > n) {
+        return NumberString{};
+    }
+    NumberString smallerK = std::min(k, n - k);
+
+    unsigned long long top, bottom;
+    if (NumberString::TryGetUnsigned(n.limbs, top) && top <= NumberString::MaxSieveLimit) {
+        // Legendre's formula gives the exponent of every prime in n! / (k! (n - k)!).
+        NumberString::TryGetUnsigned(smallerK.limbs, bottom);
+        std::vector<unsigned long long> primePowers;
+        for (uint32_t prime : NumberString::SievePrimes(static_cast<uint32_t>(top))) {
+            unsigned long long primePower = 1;
+            for (unsigned long long power = prime; power <= top; power *= prime) {
+                unsigned long long exponent = top / power - bottom / power - (top - bottom) / power;
+                if (exponent != 0) primePower *= prime;
+            }
+            if (primePower > 1) primePowers.push_back(primePower);
+        }
+        return NumberString::ProductTree(primePowers, 0, primePowers.size());
+    }
+
+    // A huge n with a small k: the falling factorial divided exactly by k!.
+    if (!NumberString::TryGetUnsigned(smallerK.limbs, bottom) || bottom > NumberString::MaxSieveLimit) {
+        throw std::length_error("NumberString binomial arguments are too large");
+    }
+    std::vector<NumberString> fallingFactors;
+    fallingFactors.reserve(bottom);
+    for (NumberString factor = n - smallerK + 1; fallingFactors.size() < bottom; factor += 1) {
+        fallingFactors.push_back(factor);
+    }
+    return NumberString::ProductTree(fallingFactors, 0, fallingFactors.size()) / !smallerK;
+}
+
+inline NumberString Primorial(NumberString const& n) {
+    unsigned long long limit = 0;
+    if (!n.isNegative
+        && (!NumberString::TryGetUnsigned(n.limbs, limit) || limit > NumberString::MaxSieveLimit)) {
+        throw std::length_error("NumberString primorial argument is too large");
+    }
+    std::vector<uint32_t> primes = NumberString::SievePrimes(static_cast<uint32_t>(limit));
+    return NumberString::ProductTree(primes, 0, primes.size());
+}
+
+
+inline NumberString IRoot(NumberString const& number, unsigned degree) {
+    if (degree == 0) {
+        throw std::domain_error("NumberString root degree must be positive");
+    }
+    if (number.isNegative && degree % 2 == 0) {
+        throw std::domain_error("Even roots of negative NumberStrings are not supported");
+    }
+    NumberString root = NumberString::RootMagnitude(number.limbs, degree);
+    root.isNegative = number.isNegative && !root.IsZero();
+    return root;
+}
+
+inline NumberString ISqrt(NumberString const& number) {
+    return IRoot(number, 2);
+}
+
+inline NumberString Gcd(NumberString const& firstNum, NumberString const& secondNum) {
+    NumberString first = firstNum, second = secondNum;
+    first.isNegative = second.isNegative = false;
+    if (first < second) {
+        std::swap(first, second);
+    }
+    NumberString::ReduceGcd(first, second, 0, nullptr);
+    return first;
+}
+
+inline std::tuple<NumberString, NumberString, NumberString> ExtendedGcd(NumberString const& firstNum,
+                                                                        NumberString const& secondNum) {
+    // Returns (g, x, y) with firstNum * x + secondNum * y = g = Gcd(firstNum, secondNum).
+    NumberString first = firstNum, second = secondNum;
+    first.isNegative = second.isNegative = false;
+    bool isSwapped = first < second;
+    if (isSwapped) {
+        std::swap(first, second);
+    }
+    NumberString::GcdMatrix matrix;
+    NumberString::ReduceGcd(first, second, 0, &matrix);
+
+    NumberString firstFactor = std::move(matrix.topLeft), secondFactor = std::move(matrix.topRight);
+    if (isSwapped) {
+        std::swap(firstFactor, secondFactor);
+    }
+    if (firstNum.isNegative && !firstFactor.IsZero()) firstFactor.isNegative = !firstFactor.isNegative;
+    if (secondNum.isNegative && !secondFactor.IsZero()) secondFactor.isNegative = !secondFactor.isNegative;
+    return { std::move(first), std::move(firstFactor), std::move(secondFactor) };
+}
+
+inline NumberString ModInverse(NumberString const& number, NumberString const& modulus) {
+    if (modulus.IsZero()) {
+        throw std::overflow_error("Division by zero exception");
+    }
+    NumberString positiveModulus = modulus;
+    positiveModulus.isNegative = false;
+    NumberString reduced = number % positiveModulus;
+    if (reduced.isNegative) reduced += positiveModulus;
+
+    auto [divisor, inverse, unused] = ExtendedGcd(reduced, positiveModulus);
+    if (divisor != 1ll) {
+        throw std::domain_error("NumberString has no inverse modulo the given modulus");
+    }
+    inverse %= positiveModulus;
+    if (inverse.isNegative) inverse += positiveModulus;
+    return inverse;
+}
+
+
+inline Divisor::Divisor(NumberString const& divisor) : value(divisor) {
+    if (divisor.IsZero()) {
+        throw std::overflow_error("Division by zero exception");
+    }
+    if (value.limbs.size() == 1) {
+        // floor((2^64 - 1) / d) underestimates 2^64 / d by less than one unit, so for
+        // every partial dividend below d * Base < 2^60 the product estimate of its
+        // quotient is short by at most one.
+        if (value.limbs.front() > 1) inverse = UINT64_MAX / value.limbs.front();
+    }
+    else if (value.limbs.size() < BarrettThreshold) {
+        scale = NumberString::Base / (value.limbs.back() + 1);
+        normalizedDivisor = value.limbs;
+        NumberString::MultiplyAddSmall(normalizedDivisor, scale, 0);
+    }
+    else {
+        reciprocal = NumberString::ReciprocalMagnitude(value.limbs);
+    }
+}
+
+inline Divisor::Limb Divisor::DivideSmall(Limbs& magnitude) const noexcept {
+    uint64_t divisor = value.limbs.front(), remainder = 0;
+    if (divisor == 1) return 0;
+    for (size_t i = magnitude.size(); i-- > 0; ) {
+        uint64_t current = remainder * NumberString::Base + magnitude[i];
+        auto estimate = static_cast<uint64_t>((static_cast<unsigned __int128>(current) * inverse) >> 64);
+        remainder = current - estimate * divisor;
+        if (remainder >= divisor) {
+            ++estimate;
+            remainder -= divisor;
+        }
+        magnitude[i] = static_cast<Limb>(estimate);
+    }
+    return static_cast<Limb>(remainder);
+}
+
+inline void Divisor::DivideMagnitudes(Limbs const& dividend, Limbs& quotient, Limbs& remainder) const {
+    Limbs const& divisor = value.limbs;
+    if (NumberString::CompareMagnitudes(dividend, divisor) < 0) {
+        quotient.clear();
+        remainder = dividend;
+    }
+    else if (divisor.size() == 1) {
+        quotient = dividend;
+        Limb smallRemainder = DivideSmall(quotient);
+        NumberString::TrimMagnitude(quotient);
+        remainder.assign(smallRemainder != 0, smallRemainder);
+    }
+    else if (reciprocal.empty()) {
+        NumberString::KnuthDivide(dividend, normalizedDivisor, scale, quotient, remainder);
+    }
+    else if (dividend.size() <= 2 * divisor.size()) {
+        NumberString::BarrettDivide(dividend, divisor, reciprocal, quotient, remainder);
+    }
+    else {
+        NumberString::NewtonDivide(dividend, divisor, reciprocal, quotient, remainder);
+    }
+}
+
+inline std::pair<NumberString, NumberString> DivMod(NumberString const& dividend, Divisor const& divisor) {
+    NumberString quotient, remainder;
+    if (dividend.FitsNative() && divisor.value.FitsNative()) {
+        quotient.AssignNative(dividend.ToNative() / divisor.value.ToNative());
+        remainder.AssignNative(dividend.ToNative() % divisor.value.ToNative());
+        return { quotient, remainder };
+    }
+    divisor.DivideMagnitudes(dividend.limbs, quotient.limbs, remainder.limbs);
+    quotient.isNegative = dividend.isNegative != divisor.value.isNegative;
+    remainder.isNegative = dividend.isNegative;
+    quotient.RemoveTrailingZeros();
+    remainder.RemoveTrailingZeros();
+    return { quotient, remainder };
+}
+
+inline NumberString operator/ (NumberString const& dividend, Divisor const& divisor) {
+    return DivMod(dividend, divisor).first;
+}
+
+inline NumberString operator% (NumberString const& dividend, Divisor const& divisor) {
+    return DivMod(dividend, divisor).second;
+}
+
+
+inline size_t NumberString::Serialize(std::span<std::byte> buffer) const {
+    size_t size = GetSerializedSize();
+    if (buffer.size() < size) {
+        throw std::length_error("Buffer is too small for the serialized NumberString");
+    }
+    std::byte* output = buffer.data();
+    output[0] = std::byte{ 'N' };
+    output[1] = std::byte{ 'S' };
+    output[2] = std::byte{ SerialFormatVersion };
+    output[3] = std::byte{ isNegative };
+    StoreLittleEndian<uint64_t>(output + 4, limbs.size());
+
+    output += SerialHeaderSize;
+    if constexpr (std::endian::native == std::endian::little) {
+        if (!limbs.empty()) std::memcpy(output, limbs.data(), limbs.size() * sizeof(Limb));
+    }
+    else {
+        for (size_t i = 0; i < limbs.size(); ++i) StoreLittleEndian(output + i * sizeof(Limb), limbs[i]);
+    }
+    return size;
+}
+
+inline NumberString NumberString::Deserialize(std::span<std::byte const> data) {
+    return NumberString(NumberStringView(data));
+}
+
+inline NumberString::NumberString(NumberStringView const& view) : isNegative(view.isNegative) {
+    limbs.resize(view.limbCount);
+    if constexpr (std::endian::native == std::endian::little) {
+        if (!limbs.empty()) std::memcpy(limbs.data(), view.limbData, limbs.size() * sizeof(Limb));
+    }
+    else {
+        for (size_t i = 0; i < limbs.size(); ++i) limbs[i] = view.GetLimb(i);
+    }
+    if (std::any_of(limbs.begin(), limbs.end(), [](Limb limb) { return limb >= Base; })) {
+        throw std::invalid_argument("Malformed NumberString binary record");
+    }
+}
+
+inline NumberStringView::NumberStringView(std::span<std::byte const> data) {
+    if (data.size() < NumberString::SerialHeaderSize
+        || data[0] != std::byte{ 'N' } || data[1] != std::byte{ 'S' }) {
+        throw std::invalid_argument("Malformed NumberString binary record");
+    }
+    if (data[2] != std::byte{ NumberString::SerialFormatVersion }) {
+        throw std::invalid_argument("Unsupported NumberString binary format version");
+    }
+
+    uint64_t count = LoadLittleEndian<uint64_t>(data.data() + 4);
+    limbData = data.data() + NumberString::SerialHeaderSize;
+    limbCount = static_cast<size_t>(count);
+    isNegative = data[3] == std::byte{ 1 };
+    if ((data[3] & ~std::byte{ 1 }) != std::byte{ 0 }
+        || count > (data.size() - NumberString::SerialHeaderSize) / sizeof(Limb)
+        || (count == 0 && isNegative)
+        || (count != 0 && (GetLimb(limbCount - 1) == 0 || GetLimb(limbCount - 1) >= NumberString::Base))) {
+        throw std::invalid_argument("Malformed NumberString binary record");
+    }
+}
+
+inline int NumberStringView::Compare(NumberString const& number) const noexcept {
+    if (isNegative != number.isNegative) {
+        return isNegative ? -1 : 1;
+    }
+    int comparison = 0;
+    if (limbCount != number.limbs.size()) {
+        comparison = (limbCount > number.limbs.size()) ? 1 : -1;
+    }
+    for (size_t i = limbCount; comparison == 0 && i-- > 0; ) {
+        Limb limb = GetLimb(i);
+        if (limb != number.limbs[i]) comparison = (limb > number.limbs[i]) ? 1 : -1;
+    }
+    return isNegative ? -comparison : comparison;
+}
+
+
+// Unsigned integer of a width fixed at compile time that lives entirely in the
+// object as Bits / 32 little-endian binary limbs. Arithmetic wraps modulo 2^Bits
+// like the built-in unsigned types, so negative integers and NumberStrings convert
+// in two's complement. Every operation is constexpr, and the limb loops of the
+// linear operations are unrolled at compile time.
+template<size_t Bits>
+class FixedInt final {
+    static_assert(Bits > 0 && Bits % 32 == 0, "FixedInt width must be a positive multiple of 32 bits");
+
+public:
+    using Limb = uint32_t;
+    static constexpr size_t LimbCount = Bits / 32;
+
+public:
+    constexpr FixedInt() noexcept = default;
+
+    template<std::integral T>
+    constexpr FixedInt(T number) noexcept {
+        auto value = static_cast<unsigned long long>(number);
+        if constexpr (std::is_signed_v<T>) {
+            limbs.fill(number < 0 ? ~Limb{ 0 } : 0);
+        }
+        limbs[0] = static_cast<Limb>(value);
+        if constexpr (LimbCount > 1) {
+            limbs[1] = static_cast<Limb>(value >> 32);
+        }
+    }
+
+    // Zero-extends a narrower value and keeps the low Bits of a wider one.
+    template<size_t OtherBits>
+    constexpr explicit FixedInt(FixedInt<OtherBits> const& other) noexcept {
+        for (size_t i = 0; i < std::min(LimbCount, other.LimbCount); ++i) {
+            limbs[i] = other.limbs[i];
+        }
+    }
+
+    constexpr explicit FixedInt(const char* strNum) {
+        std::string_view digits{ strNum };
+        bool isNegative = !digits.empty() && digits.front() == '-';
+        if (isNegative) {
+            digits.remove_prefix(1);
+        }
+        if (digits.empty() || digits.find_first_not_of("0123456789") != std::string_view::npos) {
+            throw std::invalid_argument("FixedInt can only be created from decimal digits");
+        }
+        for (size_t chunkBegin = 0, chunkLength = (digits.length() - 1) % NumberString::BaseDigits + 1;
+             chunkBegin < digits.length(); chunkBegin += chunkLength, chunkLength = NumberString::BaseDigits) {
+            Limb chunk = 0, scale = 1;
+            for (char digit : digits.substr(chunkBegin, chunkLength)) {
+                chunk = chunk * 10 + (digit - '0');
+                scale *= 10;
+            }
+            MultiplyAddSmall(scale, chunk);
+        }
+        if (isNegative) {
+            *this = FixedInt{} - *this;
+        }
+    }
+
+    explicit FixedInt(NumberString const& number) {
+        for (size_t i = number.limbs.size(); i-- > 0; ) {
+            MultiplyAddSmall(NumberString::Base, number.limbs[i]);
+        }
+        if (number.isNegative) {
+            *this = FixedInt{} - *this;
+        }
+    }
+
+    explicit operator NumberString() const {
+        NumberString result;
+        for (FixedInt rest = *this; !rest.IsZero(); ) {
+            result.limbs.push_back(rest.DivideSmall(NumberString::Base));
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::string Get() const {
+        return NumberString(*this).Get();
+    }
+
+    friend std::ostream& operator<< (std::ostream& out, FixedInt const& number) {
+        return out << NumberString(number);
+    }
+
+    friend constexpr FixedInt operator+ (FixedInt const& firstNum, FixedInt const& secondNum) noexcept {
+        FixedInt result;
+        uint64_t carry = 0;
+        Unrolled<LimbCount>([&](size_t i) {
+            carry += static_cast<uint64_t>(firstNum.limbs[i]) + secondNum.limbs[i];
+            result.limbs[i] = static_cast<Limb>(carry);
+            carry >>= 32;
+        });
+        return result;
+    }
+
+    friend constexpr FixedInt operator- (FixedInt const& firstNum, FixedInt const& secondNum) noexcept {
+        FixedInt result;
+        uint64_t borrow = 0;
+        Unrolled<LimbCount>([&](size_t i) {
+            uint64_t difference = static_cast<uint64_t>(firstNum.limbs[i]) - secondNum.limbs[i] - borrow;
+            result.limbs[i] = static_cast<Limb>(difference);
+            borrow = difference >> 63;
+        });
+        return result;
+    }
+
+    friend constexpr FixedInt operator* (FixedInt const& firstNum, FixedInt const& secondNum) noexcept {
+        // Only the partial products below 2^Bits are formed.
+        FixedInt result;
+        for (size_t i = 0; i < LimbCount; ++i) {
+            uint64_t carry = 0;
+            Unrolled<LimbCount>([&](size_t j) {
+                if (i + j < LimbCount) {
+                    carry += static_cast<uint64_t>(firstNum.limbs[i]) * secondNum.limbs[j] + result.limbs[i + j];
+                    result.limbs[i + j] = static_cast<Limb>(carry);
+                    carry >>= 32;
+                }
+            });
+        }
+        return result;
+    }
+
+    friend constexpr FixedInt operator/ (FixedInt const& firstNum, FixedInt const& secondNum) {
+        FixedInt quotient, remainder;
+        Divide(firstNum, secondNum, quotient, remainder);
+        return quotient;
+    }
+
+    friend constexpr FixedInt operator% (FixedInt const& firstNum, FixedInt const& secondNum) {
+        FixedInt quotient, remainder;
+        Divide(firstNum, secondNum, quotient, remainder);
+        return remainder;
+    }
+
+    friend constexpr FixedInt operator^ (FixedInt number, FixedInt const& power) noexcept {
+        FixedInt result{ 1 };
+        for (size_t i = 0; i < LimbCount; ++i) {
+            for (Limb bits = power.limbs[i], bit = 0; bit < 32; ++bit, bits >>= 1) {
+                if (bits & 1) {
+                    result = result * number;
+                }
+                if (bits == 0 && power.IsZeroFrom(i + 1)) {
+                    return result;
+                }
+                number = number * number;
+            }
+        }
+        return result;
+    }
+
+    constexpr FixedInt& operator+= (FixedInt const& other) noexcept { return *this = *this + other; }
+    constexpr FixedInt& operator-= (FixedInt const& other) noexcept { return *this = *this - other; }
+    constexpr FixedInt& operator*= (FixedInt const& other) noexcept { return *this = *this * other; }
+    constexpr FixedInt& operator/= (FixedInt const& other) { return *this = *this / other; }
+    constexpr FixedInt& operator%= (FixedInt const& other) { return *this = *this % other; }
+    constexpr FixedInt& operator^= (FixedInt const& other) noexcept { return *this = *this ^ other; }
+
+    friend constexpr bool operator== (FixedInt const&, FixedInt const&) noexcept = default;
+
+    friend constexpr std::strong_ordering operator<=> (FixedInt const& firstNum, FixedInt const& secondNum) noexcept {
+        std::strong_ordering order = std::strong_ordering::equal;
+        Unrolled<LimbCount>([&](size_t i) {
+            size_t index = LimbCount - 1 - i;
+            if (order == 0) order = firstNum.limbs[index] <=> secondNum.limbs[index];
+        });
+        return order;
+    }
+
+private:
+    template<size_t OtherBits> friend class FixedInt;
+
+    template<size_t Count, class Body>
+    static constexpr void Unrolled(Body&& body) {
+        [&]<size_t... Indices>(std::index_sequence<Indices...>) {
+            (body(Indices), ...);
+        }(std::make_index_sequence<Count>{});
+    }
+
+    [[nodiscard]] constexpr bool IsZeroFrom(size_t from) const noexcept {
+        for (size_t i = from; i < LimbCount; ++i) {
+            if (limbs[i] != 0) return false;
+        }
+        return true;
+    }
+    [[nodiscard]] constexpr bool IsZero() const noexcept {
+        return IsZeroFrom(0);
+    }
+    [[nodiscard]] constexpr size_t SignificantLimbs() const noexcept {
+        size_t count = LimbCount;
+        while (count > 0 && limbs[count - 1] == 0) --count;
+        return count;
+    }
+
+    constexpr void MultiplyAddSmall(Limb multiplier, Limb addend) noexcept {
+        uint64_t carry = addend;
+        Unrolled<LimbCount>([&](size_t i) {
+            carry += static_cast<uint64_t>(limbs[i]) * multiplier;
+            limbs[i] = static_cast<Limb>(carry);
+            carry >>= 32;
+        });
+    }
+
+    constexpr Limb DivideSmall(Limb divisor) noexcept {
+        uint64_t remainder = 0;
+        for (size_t i = LimbCount; i-- > 0; ) {
+            remainder = (remainder << 32) | limbs[i];
+            limbs[i] = static_cast<Limb>(remainder / divisor);
+            remainder %= divisor;
+        }
+        return static_cast<Limb>(remainder);
+    }
+
+    // Knuth's Algorithm D on base 2^32 limbs, with both operands shifted so that
+    // the divisor's top limb has its high bit set.
+    static constexpr void Divide(FixedInt const& dividend, FixedInt const& divisor,
+                                 FixedInt& quotient, FixedInt& remainder) {
+        size_t divisorLength = divisor.SignificantLimbs(), dividendLength = dividend.SignificantLimbs();
+        if (divisorLength == 0) {
+            throw std::overflow_error("Division by zero exception");
+        }
+        quotient = FixedInt{};
+        if (dividend < divisor) {
+            remainder = dividend;
+            return;
+        }
+        if (divisorLength == 1) {
+            quotient = dividend;
+            remainder = FixedInt{ quotient.DivideSmall(divisor.limbs[0]) };
+            return;
+        }
+
+        int shift = std::countl_zero(divisor.limbs[divisorLength - 1]);
+        auto shifted = [shift](Limb high, Limb low) {
+            return static_cast<Limb>(shift ? (high << shift) | (low >> (32 - shift)) : high);
+        };
+        std::array<Limb, LimbCount> normalizedDivisor{};
+        std::array<Limb, LimbCount + 1> normalizedDividend{};
+        for (size_t i = 0; i < divisorLength; ++i) {
+            normalizedDivisor[i] = shifted(divisor.limbs[i], i ? divisor.limbs[i - 1] : 0);
+        }
+        normalizedDividend[dividendLength] = shifted(0, dividend.limbs[dividendLength - 1]);
+        for (size_t i = 0; i < dividendLength; ++i) {
+            normalizedDividend[i] = shifted(dividend.limbs[i], i ? dividend.limbs[i - 1] : 0);
+        }
+
+        uint64_t topLimb = normalizedDivisor[divisorLength - 1], nextLimb = normalizedDivisor[divisorLength - 2];
+        for (size_t j = dividendLength - divisorLength + 1; j-- > 0; ) {
+            uint64_t numerator = (static_cast<uint64_t>(normalizedDividend[j + divisorLength]) << 32)
+                                 | normalizedDividend[j + divisorLength - 1];
+            uint64_t estimate = numerator / topLimb, estimateRemainder = numerator % topLimb;
+            while (estimate >> 32
+                   || estimate * nextLimb > ((estimateRemainder << 32) | normalizedDividend[j + divisorLength - 2])) {
+                --estimate;
+                estimateRemainder += topLimb;
+                if (estimateRemainder >> 32) break;
+            }
+
+            int64_t borrow = 0;
+            for (size_t i = 0; i < divisorLength; ++i) {
+                uint64_t product = estimate * normalizedDivisor[i];
+                int64_t difference = normalizedDividend[i + j] - borrow - static_cast<int64_t>(product & 0xFFFFFFFF);
+                normalizedDividend[i + j] = static_cast<Limb>(difference);
+                borrow = static_cast<int64_t>(product >> 32) - (difference >> 32);
+            }
+            int64_t top = normalizedDividend[j + divisorLength] - borrow;
+            normalizedDividend[j + divisorLength] = static_cast<Limb>(top);
+
+            // The estimate can still be one too large, which the add-back repairs.
+            if (top < 0) {
+                --estimate;
+                uint64_t carry = 0;
+                for (size_t i = 0; i < divisorLength; ++i) {
+                    carry += static_cast<uint64_t>(normalizedDividend[i + j]) + normalizedDivisor[i];
+                    normalizedDividend[i + j] = static_cast<Limb>(carry);
+                    carry >>= 32;
+                }
+                normalizedDividend[j + divisorLength] += static_cast<Limb>(carry);
+            }
+            quotient.limbs[j] = static_cast<Limb>(estimate);
+        }
+
+        remainder = FixedInt{};
+        for (size_t i = 0; i < divisorLength; ++i) {
+            remainder.limbs[i] = shift ? (normalizedDividend[i] >> shift) | (normalizedDividend[i + 1] << (32 - shift))
+                                       : normalizedDividend[i];
+        }
+    }
+
+private:
+    std::array<Limb, LimbCount> limbs{};
+};
+
+
+// Many independent NumberStrings of bounded size stored as a structure of arrays:
+// row j holds limb j of every lane, rows are padded to a multiple of LanePadding
+// lanes, and the signs sit in an array of their own. The batch operations write
+// into preallocated result batches and run one row at a time across all lanes, so
+// the lane loops are branch-free and vectorize; lane ranges are spread over the
+// thread pool once SetThreadCount enables it.
+class NumberBatch final {
+public:
+    using Limb = NumberString::Limb;
+    static constexpr size_t LanePadding = 16;
+
+public:
+    NumberBatch(size_t _laneCount, size_t _limbCount)
+            : laneCount(_laneCount), limbCount(_limbCount),
+              stride((_laneCount + LanePadding - 1) / LanePadding * LanePadding),
+              limbs(stride * _limbCount), signs(_laneCount) {}
+
+    explicit NumberBatch(std::vector<NumberString> const& numbers)
+            : NumberBatch(numbers.size(), MaxLimbCount(numbers)) {
+        for (size_t lane = 0; lane < numbers.size(); ++lane) {
+            Set(lane, numbers[lane]);
+        }
+    }
+
+    [[nodiscard]] size_t GetLaneCount() const noexcept { return laneCount; }
+    [[nodiscard]] size_t GetLimbCount() const noexcept { return limbCount; }
+
+    void Set(size_t lane, NumberString const& number) {
+        if (lane >= laneCount) {
+            throw std::out_of_range("NumberBatch lane is out of range");
+        }
+        if (number.limbs.size() > limbCount) {
+            throw std::length_error("NumberString is too long for this NumberBatch");
+        }
+        for (size_t row = 0; row < limbCount; ++row) {
+            Row(row)[lane] = (row < number.limbs.size()) ? number.limbs[row] : 0;
+        }
+        signs[lane] = number.isNegative;
+    }
+
+    [[nodiscard]] NumberString At(size_t lane) const {
+        if (lane >= laneCount) {
+            throw std::out_of_range("NumberBatch lane is out of range");
+        }
+        NumberString result;
+        result.limbs.resize(limbCount);
+        for (size_t row = 0; row < limbCount; ++row) {
+            result.limbs[row] = Row(row)[lane];
+        }
+        result.isNegative = signs[lane];
+        result.RemoveTrailingZeros();
+        return result;
+    }
+
+    // result[i] = first[i] + second[i]; result may be one of the operands. It needs at
+    // least the limbs of the wider operand, and a sum that still overflows them throws
+    // std::overflow_error with result left unspecified.
+    static void AddN(NumberBatch const& first, NumberBatch const& second, NumberBatch& result);
+    // result[i] = first[i] * second[i]; result needs the limbs of both operands together.
+    static void MulN(NumberBatch const& first, NumberBatch const& second, NumberBatch& result);
+    // The sum of all lanes.
+    [[nodiscard]] static NumberString SumReduce(NumberBatch const& batch);
+    // The sum of first[i] * second[i] over all lanes.
+    [[nodiscard]] static NumberString Dot(NumberBatch const& first, NumberBatch const& second);
+
+private:
+    static constexpr Limb Base = NumberString::Base;
+
+    [[nodiscard]] Limb* Row(size_t row) noexcept { return limbs.data() + row * stride; }
+    [[nodiscard]] Limb const* Row(size_t row) const noexcept { return limbs.data() + row * stride; }
+
+    static size_t MaxLimbCount(std::vector<NumberString> const& numbers) noexcept {
+        size_t count = 0;
+        for (NumberString const& number : numbers) {
+            count = std::max(count, number.limbs.size());
+        }
+        return count;
+    }
+
+    static void CheckShapes(NumberBatch const& first, NumberBatch const& second, NumberBatch const* result,
+                            size_t resultLimbCount);
+    static void MultiplyLanes(NumberBatch const& first, NumberBatch const& second, NumberBatch& result,
+                              size_t from, size_t to);
+    static NumberString FromColumns(std::vector<__int128> columns);
+
+private:
+    size_t laneCount;
+    size_t limbCount;
+    size_t stride;
+    std::vector<Limb> limbs;
+    std::vector<uint8_t> signs;
+};
+
+inline void NumberBatch::CheckShapes(NumberBatch const& first, NumberBatch const& second, NumberBatch const* result,
+                                     size_t resultLimbCount) {
+    if (first.laneCount != second.laneCount || (result && result->laneCount != first.laneCount)) {
+        throw std::invalid_argument("NumberBatch lane counts differ");
+    }
+    if (result && result->limbCount < resultLimbCount) {
+        throw std::length_error("NumberBatch result is too narrow");
+    }
+}
+
+inline void NumberBatch::AddN(NumberBatch const& first, NumberBatch const& second, NumberBatch& result) {
+    CheckShapes(first, second, &result, std::max(first.limbCount, second.limbCount));
+    NumberString::ParallelFor(first.laneCount, [&](size_t from, size_t to) {
+        // Lanes of opposite signs subtract magnitudes; a borrow left after the top
+        // row means the second magnitude was larger, and that lane is complemented
+        // in a second pass.
+        size_t count = to - from;
+        std::vector<int32_t> carries(count), subtractMasks(count);
+        std::vector<uint8_t> isNonZero(count);
+        for (size_t i = 0; i < count; ++i) {
+            subtractMasks[i] = -static_cast<int32_t>(first.signs[from + i] != second.signs[from + i]);
+        }
+        for (size_t row = 0; row < result.limbCount; ++row) {
+            Limb const* firstRow = (row < first.limbCount) ? first.Row(row) + from : nullptr;
+            Limb const* secondRow = (row < second.limbCount) ? second.Row(row) + from : nullptr;
+            Limb* resultRow = result.Row(row) + from;
+            for (size_t i = 0; i < count; ++i) {
+                int32_t firstLimb = firstRow ? static_cast<int32_t>(firstRow[i]) : 0;
+                int32_t secondLimb = secondRow ? static_cast<int32_t>(secondRow[i]) : 0;
+                int32_t sum = firstLimb + ((secondLimb ^ subtractMasks[i]) - subtractMasks[i]) + carries[i];
+                carries[i] = (sum >= static_cast<int32_t>(Base)) - (sum < 0);
+                resultRow[i] = static_cast<Limb>(sum - carries[i] * static_cast<int32_t>(Base));
+                isNonZero[i] |= (resultRow[i] != 0);
+            }
+        }
+
+        if (std::any_of(carries.begin(), carries.end(), [](int32_t carry) { return carry > 0; })) {
+            throw std::overflow_error("NumberBatch sum does not fit the result");
+        }
+        if (std::any_of(carries.begin(), carries.end(), [](int32_t carry) { return carry < 0; })) {
+            std::vector<Limb> borrows(count);
+            for (size_t row = 0; row < result.limbCount; ++row) {
+                Limb* resultRow = result.Row(row) + from;
+                for (size_t i = 0; i < count; ++i) {
+                    Limb complementMask = -static_cast<Limb>(carries[i] < 0);
+                    Limb subtrahend = resultRow[i] + borrows[i];
+                    Limb complement = subtrahend ? Base - subtrahend : 0;
+                    borrows[i] = (subtrahend != 0) & complementMask;
+                    resultRow[i] = (complement & complementMask) | (resultRow[i] & ~complementMask);
+                }
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            result.signs[from + i] = isNonZero[i] && (first.signs[from + i] != (carries[i] < 0));
+        }
+    });
+}
+
+inline void NumberBatch::MultiplyLanes(NumberBatch const& first, NumberBatch const& second, NumberBatch& result,
+                                       size_t from, size_t to) {
+    // Row-by-row schoolbook multiplication with the lanes innermost: the lanes carry
+    // independently, so their multiply-divide chains overlap instead of queueing.
+    size_t count = to - from;
+    for (size_t row = 0; row < result.limbCount; ++row) {
+        std::fill_n(result.Row(row) + from, count, 0);
+    }
+    std::vector<uint64_t> carries(count);
+    for (size_t i = 0; i < first.limbCount; ++i) {
+        std::fill(carries.begin(), carries.end(), 0);
+        Limb const* firstRow = first.Row(i) + from;
+        for (size_t j = 0; j < second.limbCount; ++j) {
+            Limb const* secondRow = second.Row(j) + from;
+            Limb* resultRow = result.Row(i + j) + from;
+            for (size_t lane = 0; lane < count; ++lane) {
+                uint64_t current = resultRow[lane] + static_cast<uint64_t>(firstRow[lane]) * secondRow[lane]
+                                   + carries[lane];
+                resultRow[lane] = static_cast<Limb>(current % Base);
+                carries[lane] = current / Base;
+            }
+        }
+        Limb* carryRow = result.Row(i + second.limbCount) + from;
+        for (size_t lane = 0; lane < count; ++lane) {
+            carryRow[lane] = static_cast<Limb>(carries[lane]);
+        }
+    }
+}
+
+inline void NumberBatch::MulN(NumberBatch const& first, NumberBatch const& second, NumberBatch& result) {
+    CheckShapes(first, second, &result, first.limbCount + second.limbCount);
+    if (&result == &first || &result == &second) {
+        throw std::invalid_argument("NumberBatch product cannot overwrite its operands");
+    }
+    NumberString::ParallelFor(first.laneCount, [&](size_t from, size_t to) {
+        if (std::min(first.limbCount, second.limbCount) < NumberString::KaratsubaThreshold) {
+            MultiplyLanes(first, second, result, from, to);
+        }
+        else {
+            for (size_t lane = from; lane < to; ++lane) {
+                result.Set(lane, first.At(lane) * second.At(lane));
+            }
+        }
+        for (size_t lane = from; lane < to; ++lane) {
+            bool isZero = true;
+            for (size_t row = 0; row < result.limbCount && isZero; ++row) {
+                isZero = (result.Row(row)[lane] == 0);
+            }
+            result.signs[lane] = !isZero && first.signs[lane] != second.signs[lane];
+        }
+    });
+}
+
+inline NumberString NumberBatch::SumReduce(NumberBatch const& batch) {
+    std::vector<__int128> columns(batch.limbCount);
+    std::mutex columnsMutex;
+    NumberString::ParallelFor(batch.laneCount, [&](size_t from, size_t to) {
+        std::vector<__int128> partialColumns(batch.limbCount);
+        for (size_t row = 0; row < batch.limbCount; ++row) {
+            Limb const* limbRow = batch.Row(row);
+            int64_t positive = 0, negative = 0;
+            for (size_t lane = from; lane < to; ++lane) {
+                int64_t limb = limbRow[lane], mask = -static_cast<int64_t>(batch.signs[lane]);
+                negative += limb & mask;
+                positive += limb & ~mask;
+            }
+            partialColumns[row] = static_cast<__int128>(positive) - negative;
+        }
+        std::lock_guard lock(columnsMutex);
+        for (size_t row = 0; row < batch.limbCount; ++row) {
+            columns[row] += partialColumns[row];
+        }
+    });
+    return FromColumns(std::move(columns));
+}
+
+inline NumberString NumberBatch::Dot(NumberBatch const& first, NumberBatch const& second) {
+    CheckShapes(first, second, nullptr, 0);
+    std::vector<__int128> columns(first.limbCount + second.limbCount);
+    std::mutex columnsMutex;
+    NumberString::ParallelFor(first.laneCount, [&](size_t from, size_t to) {
+        // Fewer than eighteen products below 10^18 fit one uint64_t, so the lanes are
+        // summed in blocks of LanePadding before reaching the wide column totals.
+        std::vector<__int128> partialColumns(columns.size());
+        for (size_t i = 0; i < first.limbCount; ++i) {
+            for (size_t j = 0; j < second.limbCount; ++j) {
+                Limb const* firstRow = first.Row(i);
+                Limb const* secondRow = second.Row(j);
+                __int128 column = 0;
+                for (size_t blockFrom = from; blockFrom < to; blockFrom += LanePadding) {
+                    uint64_t positive = 0, negative = 0;
+                    for (size_t lane = blockFrom; lane < std::min(blockFrom + LanePadding, to); ++lane) {
+                        uint64_t product = static_cast<uint64_t>(firstRow[lane]) * secondRow[lane];
+                        uint64_t mask = -static_cast<uint64_t>(first.signs[lane] != second.signs[lane]);
+                        negative += product & mask;
+                        positive += product & ~mask;
+                    }
+                    column += static_cast<__int128>(positive) - static_cast<__int128>(negative);
+                }
+                partialColumns[i + j] += column;
+            }
+        }
+        std::lock_guard lock(columnsMutex);
+        for (size_t k = 0; k < columns.size(); ++k) {
+            columns[k] += partialColumns[k];
+        }
+    });
+    return FromColumns(std::move(columns));
+}
+
+inline NumberString NumberBatch::FromColumns(std::vector<__int128> columns) {
+    // Turns column totals of any sign into limbs; a negative total is negated and
+    // carried once more.
+    NumberString result;
+    for (bool isNegated : { false, true }) {
+        result.limbs.resize(columns.size());
+        __int128 carry = 0;
+        for (size_t k = 0; k < columns.size(); ++k) {
+            __int128 column = (isNegated ? -columns[k] : columns[k]) + carry;
+            carry = column / Base;
+            column %= Base;
+            if (column < 0) {
+                column += Base;
+                --carry;
+            }
+            result.limbs[k] = static_cast<Limb>(column);
+        }
+        if (carry >= 0) {
+            for (; carry > 0; carry /= Base) {
+                result.limbs.push_back(static_cast<Limb>(carry % Base));
+            }
+            result.isNegative = isNegated;
+            break;
+        }
+    }
+    result.RemoveTrailingZeros();
+    return result;
+}
+
+
+
+// Rounding applied when a BigFloat result has more significant digits than its
+// precision allows.
+enum class RoundingMode {
+    HalfEven,
+    HalfAwayFromZero,
+    TowardZero,
+    AwayFromZero,
+    TowardPositive,
+    TowardNegative
+};
+
+// Decimal floating-point number mantissa * 10^exponent with a NumberString mantissa,
+// so its arithmetic runs on the NumberString multiplication and division tiers.
+// Every result is rounded to precision significant digits in the given rounding
+// mode; a binary operation takes the larger precision of its operands and the
+// rounding mode of the first one. Results that fit the precision are exact, so
+// amounts with a fixed number of decimals add up without representation error.
+class BigFloat final {
+public:
+    static inline size_t DefaultPrecision = 50;
+
+public:
+    BigFloat(long long number = 0) : BigFloat(NumberString{ number }) {}
+
+    BigFloat(NumberString _mantissa, int64_t _exponent = 0, size_t _precision = DefaultPrecision,
+             RoundingMode _rounding = RoundingMode::HalfEven)
+            : mantissa(std::move(_mantissa)), exponent(_exponent), precision(_precision), rounding(_rounding) {
+        if (precision == 0) {
+            throw std::invalid_argument("BigFloat precision must be positive");
+        }
+        Round();
+    }
+
+    // Accepts plain and scientific notation such as "-12.50", ".5" or "6.02214076e23".
+    explicit BigFloat(const char* strNum, size_t precision = DefaultPrecision,
+                      RoundingMode rounding = RoundingMode::HalfEven);
+
+    [[nodiscard]] NumberString const& GetMantissa() const noexcept { return mantissa; }
+    [[nodiscard]] int64_t GetExponent() const noexcept { return exponent; }
+    [[nodiscard]] size_t GetPrecision() const noexcept { return precision; }
+    [[nodiscard]] RoundingMode GetRoundingMode() const noexcept { return rounding; }
+
+    // The same value rounded to another precision and rounding mode.
+    [[nodiscard]] BigFloat Rounded(size_t newPrecision, RoundingMode newRounding) const {
+        return BigFloat(mantissa, exponent, newPrecision, newRounding);
+    }
+
+    // The integer part, i.e. the value truncated toward zero.
+    [[nodiscard]] NumberString ToNumberString() const;
+
+    // Plain notation unless that would take more padding zeros than the precision,
+    // then scientific notation.
+    [[nodiscard]] std::string Get() const;
+
+    friend std::ostream& operator<< (std::ostream& out, BigFloat const& number) {
+        return out << number.Get();
+    }
+
+    friend BigFloat operator+ (BigFloat const& firstNum, BigFloat const& secondNum) {
+        return Add(firstNum, secondNum, false);
+    }
+    friend BigFloat operator- (BigFloat const& firstNum, BigFloat const& secondNum) {
+        return Add(firstNum, secondNum, true);
+    }
+    friend BigFloat operator* (BigFloat const& firstNum, BigFloat const& secondNum) {
+        return BigFloat(firstNum.mantissa * secondNum.mantissa, firstNum.exponent + secondNum.exponent,
+                        std::max(firstNum.precision, secondNum.precision), firstNum.rounding);
+    }
+    friend BigFloat operator/ (BigFloat const& firstNum, BigFloat const& secondNum) {
+        return Divide(firstNum, secondNum);
+    }
+    friend BigFloat Sqrt(BigFloat const& number) {
+        return SquareRoot(number);
+    }
+
+    BigFloat operator- () const {
+        BigFloat result = *this;
+        if (!result.mantissa.IsZero()) result.mantissa.isNegative = !result.mantissa.isNegative;
+        return result;
+    }
+
+    BigFloat& operator+= (BigFloat const& other) {
+        return *this = *this + other;
+    }
+    BigFloat& operator-= (BigFloat const& other) {
+        return *this = *this - other;
+    }
+    BigFloat& operator*= (BigFloat const& other) {
+        return *this = *this * other;
+    }
+    BigFloat& operator/= (BigFloat const& other) {
+        return *this = *this / other;
+    }
+
+    friend bool operator== (BigFloat const& firstNum, BigFloat const& secondNum) {
+        return Compare(firstNum, secondNum) == 0;
+    }
+    friend std::strong_ordering operator<=> (BigFloat const& firstNum, BigFloat const& secondNum) {
+        return Compare(firstNum, secondNum) <=> 0;
+    }
+
+    // Series constants evaluated by binary splitting: the sum of N terms becomes one
+    // fraction whose numerator and denominator are built as balanced product trees,
+    // so the large multiplications use the Karatsuba, Toom-3 and NTT tiers.
+    [[nodiscard]] static BigFloat Pi(size_t precision, RoundingMode rounding = RoundingMode::HalfEven);
+    [[nodiscard]] static BigFloat E(size_t precision, RoundingMode rounding = RoundingMode::HalfEven);
+
+private:
+    using Limb = NumberString::Limb;
+
+    // Extra digits carried by the constant evaluations before the final rounding.
+    static constexpr size_t GuardDigits = 10;
+
+    // Radicand length in digits from which square roots are taken by a
+    // multiplication-only Newton iteration instead of ISqrt.
+    static constexpr size_t NewtonRootDigits = 2000;
+
+    // Sum over a range of hypergeometric series terms as the exact fraction T / Q;
+    // P is the running product of the term ratio numerators.
+    struct SeriesSplit {
+        NumberString p, q, t;
+    };
+    template<class Leaf>
+    static SeriesSplit BinarySplit(int64_t from, int64_t to, Leaf const& leaf);
+
+    static BigFloat Add(BigFloat const& firstNum, BigFloat const& secondNum, bool isSubtraction);
+    static BigFloat Divide(BigFloat const& firstNum, BigFloat const& secondNum);
+    static BigFloat SquareRoot(BigFloat const& number);
+    static NumberString IntegerSquareRoot(NumberString const& radicand);
+    static int Compare(BigFloat const& firstNum, BigFloat const& secondNum);
+
+    [[nodiscard]] static size_t CountDigits(NumberString const& number) noexcept;
+    static void ShiftLeft(NumberString& number, size_t digits);
+    static Limb PowerOfTen(size_t digits) noexcept;
+    [[nodiscard]] int64_t GetTop() const noexcept {
+        return exponent + static_cast<int64_t>(CountDigits(mantissa));
+    }
+    void Round();
+
+private:
+    NumberString mantissa;
+    int64_t exponent;
+    size_t precision;
+    RoundingMode rounding;
+};
+
+inline BigFloat::BigFloat(const char* strNum, size_t _precision, RoundingMode _rounding)
+               : exponent(0), precision(_precision), rounding(_rounding) {
+    assert(strNum != nullptr);
+    if (precision == 0) {
+        throw std::invalid_argument("BigFloat precision must be positive");
+    }
+    std::string_view text{ strNum };
+    std::string digits;
+    if (!text.empty() && (text.front() == '-' || text.front() == '+')) {
+        if (text.front() == '-') digits += '-';
+        text.remove_prefix(1);
+    }
+
+    size_t exponentBegin = text.find_first_of("eE");
+    std::string_view significand = text.substr(0, exponentBegin);
+    size_t point = significand.find('.');
+    std::string_view integerPart = significand.substr(0, point);
+    std::string_view fractionalPart = (point == std::string_view::npos)
+            ? std::string_view{} : significand.substr(point + 1);
+    bool isMalformed = integerPart.empty() && fractionalPart.empty();
+    for (std::string_view part : { integerPart, fractionalPart }) {
+        isMalformed |= part.find_first_not_of("0123456789") != std::string_view::npos;
+    }
+
+    if (exponentBegin != std::string_view::npos) {
+        std::string_view exponentPart = text.substr(exponentBegin + 1);
+        if (!exponentPart.empty() && exponentPart.front() == '+') exponentPart.remove_prefix(1);
+        auto [end, error] = std::from_chars(exponentPart.data(), exponentPart.data() + exponentPart.size(), exponent);
+        isMalformed |= exponentPart.empty() || error != std::errc{} || end != exponentPart.data() + exponentPart.size();
+    }
+    if (isMalformed) {
+        throw std::invalid_argument("BigFloat can only be created from a decimal number");
+    }
+
+    digits.append(integerPart).append(fractionalPart);
+    if (digits.empty() || digits == "-") digits += '0';
+    mantissa = NumberString{ digits.c_str() };
+    exponent -= static_cast<int64_t>(fractionalPart.size());
+    Round();
+}
+
+inline size_t BigFloat::CountDigits(NumberString const& number) noexcept {
+    if (number.IsZero()) return 0;
+    size_t digits = (number.limbs.size() - 1) * NumberString::BaseDigits;
+    for (Limb top = number.limbs.back(); top != 0; top /= 10) ++digits;
+    return digits;
+}
+
+inline BigFloat::Limb BigFloat::PowerOfTen(size_t digits) noexcept {
+    assert(digits < NumberString::BaseDigits);
+    Limb power = 1;
+    while (digits-- > 0) power *= 10;
+    return power;
+}
+
+inline void BigFloat::ShiftLeft(NumberString& number, size_t digits) {
+    if (number.IsZero() || digits == 0) return;
+    NumberString::Limbs zeros(digits / NumberString::BaseDigits, 0);
+    number.limbs.insert(number.limbs.begin(), zeros.begin(), zeros.end());
+    NumberString::MultiplyAddSmall(number.limbs, PowerOfTen(digits % NumberString::BaseDigits), 0);
+}
+
+inline void BigFloat::Round() {
+    size_t digits = CountDigits(mantissa);
+    if (digits <= precision) {
+        if (mantissa.IsZero()) exponent = 0;
+        return;
+    }
+
+    // The dropped digits are split into the part that decides the rounding, compared
+    // against one half of the last kept digit, and a sticky flag for everything below.
+    size_t dropped = digits - precision;
+    size_t wholeLimbs = dropped / NumberString::BaseDigits, partialDigits = dropped % NumberString::BaseDigits;
+    NumberString::Limbs& limbs = mantissa.limbs;
+    Limb roundingPart, half;
+    bool isSticky;
+    if (partialDigits == 0) {
+        roundingPart = limbs[wholeLimbs - 1];
+        half = NumberString::Base / 2;
+        isSticky = std::any_of(limbs.begin(), limbs.begin() + wholeLimbs - 1, [](Limb limb) { return limb != 0; });
+        limbs = NumberString::SliceMagnitude(limbs, wholeLimbs, limbs.size());
+    }
+    else {
+        isSticky = std::any_of(limbs.begin(), limbs.begin() + wholeLimbs, [](Limb limb) { return limb != 0; });
+        limbs = NumberString::SliceMagnitude(limbs, wholeLimbs, limbs.size());
+        roundingPart = NumberString::DivideSmall(limbs, PowerOfTen(partialDigits));
+        half = PowerOfTen(partialDigits) / 2;
+        NumberString::TrimMagnitude(limbs);
+    }
+    exponent += static_cast<int64_t>(dropped);
+
+    bool isExact = roundingPart == 0 && !isSticky;
+    bool isAboveHalf = roundingPart > half || (roundingPart == half && isSticky);
+    bool isHalf = roundingPart == half && !isSticky;
+    bool isIncremented = false;
+    switch (rounding) {
+        case RoundingMode::HalfEven:
+            isIncremented = isAboveHalf || (isHalf && (limbs.front() & 1) != 0);
+            break;
+        case RoundingMode::HalfAwayFromZero:
+            isIncremented = isAboveHalf || isHalf;
+            break;
+        case RoundingMode::TowardZero:
+            break;
+        case RoundingMode::AwayFromZero:
+            isIncremented = !isExact;
+            break;
+        case RoundingMode::TowardPositive:
+            isIncremented = !isExact && !mantissa.isNegative;
+            break;
+        case RoundingMode::TowardNegative:
+            isIncremented = !isExact && mantissa.isNegative;
+            break;
+    }
+    if (isIncremented) {
+        NumberString::MultiplyAddSmall(limbs, 1, 1);
+        if (CountDigits(mantissa) > precision) {
+            NumberString::DivideSmall(limbs, 10);
+            NumberString::TrimMagnitude(limbs);
+            ++exponent;
+        }
+    }
+}
+
+inline BigFloat BigFloat::Add(BigFloat const& firstNum, BigFloat const& secondNum, bool isSubtraction) {
+    NumberString first = firstNum.mantissa, second = secondNum.mantissa;
+    int64_t firstExponent = firstNum.exponent, secondExponent = secondNum.exponent;
+    size_t precision = std::max(firstNum.precision, secondNum.precision);
+    if (isSubtraction && !second.IsZero()) second.isNegative = !second.isNegative;
+
+    // An operand lying entirely below the digits and the rounding position of the
+    // other one can only decide the rounding direction, so it is replaced by a unit
+    // just below both; this keeps the alignment shift bounded by the precision.
+    auto absorb = [precision](NumberString& small, int64_t& smallExponent, int64_t smallTop,
+                              int64_t largeExponent, int64_t largeTop) {
+        int64_t floor = std::min(largeExponent, largeTop - static_cast<int64_t>(precision) - 2);
+        if (!small.IsZero() && smallTop < floor) {
+            bool isNegative = small.isNegative;
+            small = NumberString{ 1ll };
+            small.isNegative = isNegative;
+            smallExponent = floor - 1;
+        }
+    };
+    if (!first.IsZero() && !second.IsZero()) {
+        int64_t firstTop = firstNum.GetTop(), secondTop = secondNum.GetTop();
+        absorb(second, secondExponent, secondTop, firstExponent, firstTop);
+        absorb(first, firstExponent, firstTop, secondExponent, secondTop);
+    }
+
+    if (first.IsZero()) firstExponent = secondExponent;
+    if (second.IsZero()) secondExponent = firstExponent;
+    if (firstExponent > secondExponent) {
+        ShiftLeft(first, static_cast<size_t>(firstExponent - secondExponent));
+    }
+    else {
+        ShiftLeft(second, static_cast<size_t>(secondExponent - firstExponent));
+    }
+    return BigFloat(std::move(first) + second, std::min(firstExponent, secondExponent),
+                    precision, firstNum.rounding);
+}
+
+inline BigFloat BigFloat::Divide(BigFloat const& firstNum, BigFloat const& secondNum) {
+    if (secondNum.mantissa.IsZero()) {
+        throw std::overflow_error("Division by zero exception");
+    }
+    size_t precision = std::max(firstNum.precision, secondNum.precision);
+    if (firstNum.mantissa.IsZero()) {
+        return BigFloat(NumberString{}, 0, precision, firstNum.rounding);
+    }
+
+    // The dividend is scaled until the quotient has more digits than the precision,
+    // and a nonzero remainder becomes a sticky unit in one more digit below them.
+    size_t dividendDigits = CountDigits(firstNum.mantissa);
+    size_t wantedDigits = CountDigits(secondNum.mantissa) + precision + 1;
+    size_t shift = (wantedDigits > dividendDigits) ? wantedDigits - dividendDigits : 0;
+    NumberString dividend = firstNum.mantissa;
+    ShiftLeft(dividend, shift);
+
+    auto [quotient, remainder] = DivMod(dividend, secondNum.mantissa);
+    int64_t exponent = firstNum.exponent - secondNum.exponent - static_cast<int64_t>(shift);
+    if (!remainder.IsZero()) {
+        ShiftLeft(quotient, 1);
+        quotient += quotient.isNegative ? -1 : 1;
+        --exponent;
+    }
+    return BigFloat(std::move(quotient), exponent, precision, firstNum.rounding);
+}
+
+inline BigFloat BigFloat::SquareRoot(BigFloat const& number) {
+    if (number.mantissa.isNegative) {
+        throw std::domain_error("Square root of a negative BigFloat is undefined");
+    }
+    if (number.mantissa.IsZero()) {
+        return number;
+    }
+
+    // The radicand gets at least 2 * (precision + 1) digits and an even exponent, so
+    // the integer root has more digits than the precision; an inexact root gets a
+    // sticky unit below them.
+    size_t digits = CountDigits(number.mantissa), wantedDigits = 2 * (number.precision + 1);
+    size_t shift = (wantedDigits > digits) ? wantedDigits - digits : 0;
+    if ((number.exponent - static_cast<int64_t>(shift)) % 2 != 0) ++shift;
+    NumberString radicand = number.mantissa;
+    ShiftLeft(radicand, shift);
+
+    NumberString root = IntegerSquareRoot(radicand);
+    int64_t exponent = (number.exponent - static_cast<int64_t>(shift)) / 2;
+    if (root * root != radicand) {
+        ShiftLeft(root, 1);
+        root += 1;
+        --exponent;
+    }
+    return BigFloat(std::move(root), exponent, number.precision, number.rounding);
+}
+
+inline NumberString BigFloat::IntegerSquareRoot(NumberString const& radicand) {
+    size_t digits = CountDigits(radicand);
+    if (digits < NewtonRootDigits) {
+        return ISqrt(radicand);
+    }
+
+    // x <- x + x (1 - radicand x^2) / 2 converges to 1 / sqrt(radicand) using only
+    // multiplications and doubles the correct digits every step, so it runs at
+    // doubling precisions and costs a few full-length products. A start correct to
+    // half the first precision comes from the top digits, and radicand * x is then within a few units of the
+    // root, which the exact squares at the end correct.
+    size_t rootDigits = (digits + 1) / 2 + GuardDigits;
+    std::vector<size_t> precisions;
+    for (size_t precision = rootDigits; precision > 40; precision = precision / 2 + 2) {
+        precisions.push_back(precision);
+    }
+
+    BigFloat top(radicand, 0, 90);
+    NumberString topDigits = top.mantissa;
+    int64_t topExponent = top.exponent;
+    if (topExponent % 2 != 0) {
+        ShiftLeft(topDigits, 1);
+        --topExponent;
+    }
+    BigFloat estimate = BigFloat(1ll) / BigFloat(ISqrt(topDigits), topExponent / 2, 45);
+
+    BigFloat const half(NumberString{ 5ll }, -1);
+    for (size_t i = precisions.size(); i-- > 0; ) {
+        size_t precision = precisions[i];
+        estimate = estimate.Rounded(precision, RoundingMode::HalfEven);
+        BigFloat error = BigFloat(NumberString{ 1ll }, 0, precision)
+                - BigFloat(radicand, 0, precision) * estimate * estimate;
+        estimate += estimate * error * half;
+    }
+    NumberString root = (BigFloat(radicand, 0, rootDigits) * estimate).ToNumberString();
+
+    while (root * root > radicand) {
+        root -= 1;
+    }
+    for (NumberString next = root + 1ll; next * next <= radicand; next += 1) {
+        root = next;
+    }
+    return root;
+}
+
+inline NumberString BigFloat::ToNumberString() const {
+    NumberString result = mantissa;
+    if (exponent >= 0) {
+        ShiftLeft(result, static_cast<size_t>(exponent));
+        return result;
+    }
+    size_t digits = CountDigits(mantissa), fractionalDigits = static_cast<size_t>(-exponent);
+    if (fractionalDigits >= digits) {
+        return NumberString{};
+    }
+    return BigFloat(mantissa, exponent, digits - fractionalDigits, RoundingMode::TowardZero).mantissa;
+}
+
+inline int BigFloat::Compare(BigFloat const& firstNum, BigFloat const& secondNum) {
+    auto sign = [](NumberString const& number) { return number.IsZero() ? 0 : number.isNegative ? -1 : 1; };
+    int firstSign = sign(firstNum.mantissa), secondSign = sign(secondNum.mantissa);
+    if (firstSign != secondSign || firstSign == 0) {
+        return (firstSign > secondSign) - (firstSign < secondSign);
+    }
+
+    int64_t firstTop = firstNum.GetTop(), secondTop = secondNum.GetTop();
+    if (firstTop != secondTop) {
+        return (firstTop > secondTop) ? firstSign : -firstSign;
+    }
+    NumberString first = firstNum.mantissa, second = secondNum.mantissa;
+    if (firstNum.exponent > secondNum.exponent) {
+        ShiftLeft(first, static_cast<size_t>(firstNum.exponent - secondNum.exponent));
+    }
+    else {
+        ShiftLeft(second, static_cast<size_t>(secondNum.exponent - firstNum.exponent));
+    }
+    return (first > second) - (first < second);
+}
+
+inline std::string BigFloat::Get() const {
+    std::string digits = mantissa.Get(), sign;
+    if (digits.front() == '-') {
+        sign = "-";
+        digits.erase(0, 1);
+    }
+    auto padding = static_cast<uint64_t>(exponent >= 0 ? exponent
+            : std::max<int64_t>(0, -exponent - static_cast<int64_t>(digits.size())));
+    if (mantissa.IsZero() || padding <= std::max<uint64_t>(precision, 20)) {
+        if (mantissa.IsZero()) return "0";
+        if (exponent >= 0) return sign + digits.append(static_cast<size_t>(exponent), '0');
+        size_t fractionalDigits = static_cast<size_t>(-exponent);
+        if (digits.size() <= fractionalDigits) digits.insert(0, fractionalDigits - digits.size() + 1, '0');
+        digits.insert(digits.size() - fractionalDigits, 1, '.');
+        return sign + digits;
+    }
+
+    int64_t scientificExponent = exponent + static_cast<int64_t>(digits.size()) - 1;
+    if (digits.size() > 1) digits.insert(1, 1, '.');
+    return sign + digits + (scientificExponent < 0 ? "e" : "e+") + std::to_string(scientificExponent);
+}
+
+template<class Leaf>
+BigFloat::SeriesSplit BigFloat::BinarySplit(int64_t from, int64_t to, Leaf const& leaf) {
+    // For the terms [from, to): P = p(from) ... p(to - 1), Q = q(from) ... q(to - 1)
+    // and T / Q is the partial sum, so two halves combine as T = T1 * Q2 + P1 * T2.
+    if (to - from == 1) {
+        return leaf(from);
+    }
+    int64_t middle = from + (to - from) / 2;
+    SeriesSplit left, right;
+    NumberString::RunParallel(static_cast<size_t>(to - from),
+        [&] { left = BinarySplit(from, middle, leaf); },
+        [&] { right = BinarySplit(middle, to, leaf); });
+
+    SeriesSplit result;
+    result.t = left.t * right.q + left.p * right.t;
+    result.p = std::move(left.p) * right.p;
+    result.q = std::move(left.q) * right.q;
+    return result;
+}
+
+inline BigFloat BigFloat::Pi(size_t precision, RoundingMode rounding) {
+    // Chudnovsky: 1 / pi = 12 / 640320^(3/2) * sum of (-1)^k (6k)! (13591409 + 545140134k)
+    // / ((3k)! (k!)^3 640320^(3k)), about 14.18 digits per term, rewritten as
+    // pi = 426880 sqrt(10005) Q / T.
+    size_t workingPrecision = precision + GuardDigits;
+    auto terms = static_cast<int64_t>(workingPrecision / 14 + 2);
+    SeriesSplit series = BinarySplit(0, terms, [](int64_t k) {
+        if (k == 0) {
+            return SeriesSplit{ NumberString{ 1ll }, NumberString{ 1ll }, NumberString{ 13591409ll } };
+        }
+        NumberString p = NumberString{ -(6 * k - 5) } * NumberString{ 2 * k - 1 } * NumberString{ 6 * k - 1 };
+        NumberString q = NumberString{ k * k } * NumberString{ k } * NumberString{ 10939058860032000ll };
+        NumberString t = p * NumberString{ 13591409 + 545140134 * k };
+        return SeriesSplit{ std::move(p), std::move(q), std::move(t) };
+    });
+
+    BigFloat root = Sqrt(BigFloat(NumberString{ 10005ll }, 0, workingPrecision));
+    BigFloat pi = BigFloat(NumberString{ 426880ll }, 0, workingPrecision) * root
+            * BigFloat(std::move(series.q), 0, workingPrecision) / BigFloat(std::move(series.t), 0, workingPrecision);
+    return pi.Rounded(precision, rounding);
+}
+
+inline BigFloat BigFloat::E(size_t precision, RoundingMode rounding) {
+    // e = sum of 1 / k!; with p(k) = 1 and q(k) = k the split of the terms [1, N)
+    // gives the tail sum T / Q, and enough terms are taken for (N - 1)! to exceed
+    // 10^workingPrecision.
+    size_t workingPrecision = precision + GuardDigits;
+    int64_t terms = 1;
+    for (double digits = 0; digits <= static_cast<double>(workingPrecision); ++terms) {
+        digits += std::log10(static_cast<double>(terms));
+    }
+    SeriesSplit series = BinarySplit(1, terms + 1, [](int64_t k) {
+        return SeriesSplit{ NumberString{ 1ll }, NumberString{ k }, NumberString{ 1ll } };
+    });
+
+    BigFloat denominator(series.q, 0, workingPrecision);
+    BigFloat e = BigFloat(std::move(series.q) + series.t, 0, workingPrecision) / denominator;
+    return e.Rounded(precision, rounding);
+}
@@ -1,22 +1,48 @@
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <bit>
 #include <numeric>
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
 #include <cmath>
+#include <chrono>
+#include <climits>
+#include <compare>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "BigInt.h"
 
 class Fraction {
 public:
 	typedef long long ll;
+	typedef unsigned long long ull;
+	typedef __int128 wide;
+	typedef unsigned __int128 uwide;
 
 public:
 	Fraction(int32_t _numerator = 0, int32_t _denominator = 1);
-	Fraction(Fraction const& other);
+	Fraction(NumberString const& _numerator, NumberString const& _denominator);
+	Fraction(Fraction const&) = default;
+	Fraction(Fraction&&) noexcept = default;
 	Fraction(double_t number);
 	~Fraction() = default;
 
-	void Show() noexcept;
-	[[nodiscard]] constexpr double_t ToDecimal() const noexcept(false);
+	[[nodiscard]] static Fraction Approximate(double_t number, ll maxDenominator);
+
+	void Show();
+	[[nodiscard]] double_t ToDecimal() const noexcept(false);
+
+	[[nodiscard]] NumberString GetNumerator() const;
+	[[nodiscard]] NumberString GetDenominator() const;
 
 	void Reduce() noexcept(false);
 	[[nodiscard]] Fraction Reduced() const noexcept(false);
@@ -26,76 +52,345 @@ public:
 	Fraction& operator*= (Fraction const& other);
 	Fraction& operator/= (Fraction const& other);
 	Fraction& operator= (Fraction const&) = default;
+	Fraction& operator= (Fraction&&) noexcept = default;
+
+	bool operator== (Fraction const& other) const noexcept;
+	std::strong_ordering operator<=> (Fraction const& other) const;
 
-	bool operator== (Fraction const& other) const;
-	bool operator!= (Fraction const& other) const;
-	bool operator< (Fraction const& other) const;
-	bool operator> (Fraction const& other) const;
+	[[nodiscard]] size_t Hash() const noexcept;
 
-	Fraction& operator-- () noexcept;
-	Fraction& operator++ () noexcept;
-	Fraction operator-- (int) noexcept;
-	Fraction operator++ (int) noexcept;
+	Fraction& operator-- ();
+	Fraction& operator++ ();
+	Fraction operator-- (int);
+	Fraction operator++ (int);
 
 	friend Fraction operator+ (Fraction const& thisFract, Fraction const& otherFract);
 	friend Fraction operator- (Fraction const& thisFract, Fraction const& otherFract);
 	friend Fraction operator* (Fraction const& thisFract, Fraction const& otherFract);
 	friend Fraction operator/ (Fraction const& thisFract, Fraction const& otherFract);
 
-	friend std::ostream& operator<< (std::ostream& out, Fraction const& fract) noexcept;
+	friend std::ostream& operator<< (std::ostream& out, Fraction const& fract);
 	friend std::istream& operator>> (std::istream& in, Fraction& fract);
 
+	friend class FractionArray;
+
 private:
-	static size_t CountWholeDigits(ll number);
-	static size_t CountFractionalDigits(double_t number);
+	// Exact value of a fraction whose reduced terms no longer fit into ll;
+	// the denominator is always positive.
+	struct BigRational {
+		NumberString numerator;
+		NumberString denominator;
+	};
+
+	static bool Decompose(double_t number, ull& mantissa, int& exponent);
+	static ull Magnitude(ll number) noexcept;
+	static void SteinStep(ull& first, ull& second) noexcept;
+	static ull Gcd(ull first, ull second) noexcept;
+	static std::pair<ull, ull> GcdPair(ull first, ull second, ull third, ull fourth) noexcept;
+	static NumberString ToNumberString(uwide magnitude, bool isNegative);
+	static size_t CountDigits(NumberString const& number);
+	static Fraction FromWide(wide _numerator, wide _denominator);
+	static Fraction FromBig(NumberString _numerator, NumberString _denominator);
+	static Fraction Sum(Fraction const& thisFract, Fraction const& otherFract, bool isDifference);
+	static Fraction FromTerms(ll _numerator, ll _denominator) noexcept;
+	[[nodiscard]] BigRational ToBig() const;
+	void Normalize() noexcept;
 	void AdjustSigns();
 
 private:
 	ll numerator;
 	ll denominator;
+	std::shared_ptr<BigRational const> big;
 };
 
+// Sorting and vector growth move Fractions; a move must not touch the refcount.
+static_assert(std::is_nothrow_move_constructible_v<Fraction> && std::is_nothrow_move_assignable_v<Fraction>);
+
 
 Fraction::Fraction(int32_t _numerator, int32_t _denominator)
 : numerator(_numerator), denominator(_denominator) {
 if (denominator == 0) {
 	throw std::logic_error("Fraction with denominator = 0 cannot be created");
 }
+	Normalize();
  }
 
-Fraction::Fraction(Fraction const& other)
-: numerator(other.numerator), denominator(other.denominator)
-{ assert(denominator != 0); }
+Fraction::Fraction(NumberString const& _numerator, NumberString const& _denominator)
+: numerator(0), denominator(1) {
+	if (_denominator == NumberString{}) {
+		throw std::logic_error("Fraction with denominator = 0 cannot be created");
+	}
+	*this = FromBig(_numerator, _denominator);
+}
 
 
-Fraction::Fraction(double_t number) {
-	assert(number != 0);
-	size_t fractPart = CountFractionalDigits(number);
-	numerator = static_cast<ll>(number * (pow(10, fractPart)));
-	denominator = (!fractPart) ? 1 : static_cast<ll>(pow(10, fractPart));
+// The bits of a finite double are mantissa * 2^exponent; the mantissa is made odd
+// whenever the exponent is negative. Returns whether the number is negative.
+bool Fraction::Decompose(double_t number, ull& mantissa, int& exponent) {
+	if (!std::isfinite(number)) {
+		throw std::domain_error("Fraction cannot be created from infinity or NaN");
+	}
+	const int mantissaBits = 52, exponentBias = 1075;
+	uint64_t bits = std::bit_cast<uint64_t>(number);
+	exponent = static_cast<int>((bits >> mantissaBits) & 0x7FF);
+	mantissa = bits & ((1ull << mantissaBits) - 1);
+	if (exponent) {
+		mantissa |= 1ull << mantissaBits;
+	} else {
+		exponent = 1;
+	}
+	exponent -= exponentBias;
+	if (!mantissa) {
+		exponent = 0;
+	} else if (exponent < 0) {
+		int shift = std::min(__builtin_ctzll(mantissa), -exponent);
+		mantissa >>= shift; exponent += shift;
+	}
+	return bits >> 63;
 }
 
-size_t Fraction::CountWholeDigits(ll number) {
-	size_t count = 0; for (count; number; ++count) number /= 10; return count;
+// Exact value of the double, so the denominator is always a power of two.
+Fraction::Fraction(double_t number) : numerator(0), denominator(1) {
+	ull mantissa;
+	int exponent;
+	bool isNegative = Decompose(number, mantissa, exponent);
+
+	if (exponent >= 0 && exponent + std::bit_width(mantissa) <= 63) {
+		numerator = static_cast<ll>(mantissa << exponent);
+	} else if (exponent < 0 && -exponent <= 62) {
+		numerator = static_cast<ll>(mantissa); denominator = 1ll << -exponent;
+	} else {
+		NumberString power = NumberString{ 2ll } ^ NumberString{ static_cast<long long>(std::abs(exponent)) };
+		NumberString bigNumerator{ isNegative ? -static_cast<ll>(mantissa) : static_cast<ll>(mantissa) };
+		big = std::make_shared<BigRational const>((exponent >= 0)
+			? BigRational{ bigNumerator * power, NumberString{ 1ll } } : BigRational{ bigNumerator, power });
+		return;
+	}
+	if (isNegative) {
+		numerator = -numerator;
+	}
 }
 
-size_t Fraction::CountFractionalDigits(double_t number) {
-	const int maxDoublePrecision = 16;
-	size_t unusedPrec = 0, wholePart = CountWholeDigits(static_cast<ll>(number));
-	ll fractBits = static_cast<ll>(number * (pow(10, (maxDoublePrecision - wholePart))));
+// Best rational approximation with a denominator of at most maxDenominator: the
+// continued fraction of the exact value is walked down the Stern-Brocot tree
+// until the next convergent's denominator exceeds the bound, and the last
+// convergent is compared with the largest semiconvergent that still fits.
+Fraction Fraction::Approximate(double_t number, ll maxDenominator) {
+	if (maxDenominator < 1) {
+		throw std::invalid_argument("Maximal denominator must be positive");
+	}
+	ull mantissa;
+	int exponent;
+	bool isNegative = Decompose(number, mantissa, exponent);
+	if (exponent >= 0 || (-exponent <= 62 && (1ll << -exponent) <= maxDenominator)) {
+		return Fraction(number);
+	}
+	// A denominator beyond 2^126 means |number| < 2^-73, which is closer to 0 than
+	// to 1/maxDenominator for any ll bound.
+	const int maxWideExponent = 126;
+	if (-exponent > maxWideExponent) {
+		return Fraction();
+	}
 
-	if ((number - static_cast<ll>(number)) == 0) {
-		return 0;
+	uwide remainderNumerator = mantissa, remainderDenominator = uwide{ 1 } << -exponent;
+	uwide previousNumerator = 0, previousDenominator = 1, lastNumerator = 1, lastDenominator = 0;
+	uwide bound = static_cast<uwide>(maxDenominator);
+	while (remainderDenominator) {
+		uwide quotient = remainderNumerator / remainderDenominator;
+		uwide nextDenominator = previousDenominator + quotient * lastDenominator;
+		if (nextDenominator > bound) {
+			break;
+		}
+		uwide nextNumerator = previousNumerator + quotient * lastNumerator;
+		previousNumerator = lastNumerator; previousDenominator = lastDenominator;
+		lastNumerator = nextNumerator; lastDenominator = nextDenominator;
+		uwide nextRemainder = remainderNumerator - quotient * remainderDenominator;
+		remainderNumerator = remainderDenominator; remainderDenominator = nextRemainder;
+	}
+
+	auto make = [isNegative](uwide _numerator, uwide _denominator) {
+		wide signedNumerator = static_cast<wide>(_numerator);
+		return FromWide(isNegative ? -signedNumerator : signedNumerator, static_cast<wide>(_denominator));
+	};
+	uwide steps = (bound - previousDenominator) / lastDenominator;
+	Fraction convergent = make(lastNumerator, lastDenominator);
+	Fraction semiconvergent = make(previousNumerator + steps * lastNumerator, previousDenominator + steps * lastDenominator);
+
+	Fraction exact(number);
+	auto distance = [&exact](Fraction const& fract) {
+		return (fract < exact) ? exact - fract : fract - exact;
+	};
+	return (distance(convergent) <= distance(semiconvergent)) ? convergent : semiconvergent;
+}
+
+Fraction::ull Fraction::Magnitude(ll number) noexcept {
+	return (number < 0) ? 0ull - static_cast<ull>(number) : static_cast<ull>(number);
+}
+
+// One step of the binary (Stein) gcd on two distinct odd terms: only a subtraction
+// and a shift, no 64-bit division. The difference and the new minimum do not
+// depend on each other, so they compile to conditional moves, not a branch.
+inline void Fraction::SteinStep(ull& first, ull& second) noexcept {
+	ull difference = (first > second) ? first - second : second - first;
+	first = std::min(first, second);
+	second = difference >> __builtin_ctzll(difference);
+}
+
+Fraction::ull Fraction::Gcd(ull first, ull second) noexcept {
+	if (!first || !second) {
+		return first | second;
+	}
+	int shift = __builtin_ctzll(first | second);
+	first >>= __builtin_ctzll(first); second >>= __builtin_ctzll(second);
+	while (first != second) {
+		SteinStep(first, second);
+	}
+	return first << shift;
+}
+
+// gcd(first, second) and gcd(third, fourth) together: the two loops are
+// independent, so interleaving their steps lets them overlap in the pipeline.
+std::pair<Fraction::ull, Fraction::ull> Fraction::GcdPair(ull first, ull second, ull third, ull fourth) noexcept {
+	if (!first || !second || !third || !fourth) {
+		return { Gcd(first, second), Gcd(third, fourth) };
+	}
+	int firstShift = __builtin_ctzll(first | second), secondShift = __builtin_ctzll(third | fourth);
+	first >>= __builtin_ctzll(first); second >>= __builtin_ctzll(second);
+	third >>= __builtin_ctzll(third); fourth >>= __builtin_ctzll(fourth);
+	while (first != second && third != fourth) {
+		SteinStep(first, second); SteinStep(third, fourth);
+	}
+	while (first != second) {
+		SteinStep(first, second);
+	}
+	while (third != fourth) {
+		SteinStep(third, fourth);
+	}
+	return { first << firstShift, third << secondShift };
+}
+
+// Native fractions are kept in lowest terms with a positive denominator, which is
+// what lets the operators cross-reduce instead of reducing their products.
+void Fraction::Normalize() noexcept {
+	AdjustSigns();
+	ll gcd = static_cast<ll>(Gcd(Magnitude(numerator), Magnitude(denominator)));
+	if (gcd > 1) {
+		numerator /= gcd; denominator /= gcd;
+	}
+}
+
+NumberString Fraction::ToNumberString(uwide magnitude, bool isNegative) {
+	std::string digits;
+	do {
+		digits.insert(digits.begin(), static_cast<char>('0' + magnitude % 10)); magnitude /= 10;
+	} while (magnitude);
+	if (isNegative) {
+		digits.insert(digits.begin(), '-');
 	}
-	for (int i = 0, IsZero = 1; IsZero && i < maxDoublePrecision; ++i, fractBits /= 10) {
-		if (IsZero = (fractBits % 10 == 0)) {
-			unusedPrec++;
+	return NumberString{ digits.c_str() };
+}
+
+size_t Fraction::CountDigits(NumberString const& number) {
+	std::string digits = number.Get();
+	return digits.length() - (digits.front() == '-');
+}
+
+// Keeps an already reduced 128-bit result native when both terms fit into ll;
+// otherwise the value is promoted to a BigRational.
+Fraction Fraction::FromWide(wide _numerator, wide _denominator) {
+	assert(_denominator != 0);
+	bool isNegative = (_numerator < 0) != (_denominator < 0);
+	uwide numMagnitude = (_numerator < 0) ? uwide{ 0 } - static_cast<uwide>(_numerator) : static_cast<uwide>(_numerator);
+	uwide denMagnitude = (_denominator < 0) ? uwide{ 0 } - static_cast<uwide>(_denominator) : static_cast<uwide>(_denominator);
+
+	Fraction result;
+	if (numMagnitude <= LLONG_MAX && denMagnitude <= LLONG_MAX) {
+		result.numerator = isNegative ? -static_cast<ll>(numMagnitude) : static_cast<ll>(numMagnitude);
+		result.denominator = static_cast<ll>(denMagnitude);
+	} else {
+		result.big = std::make_shared<BigRational const>(
+			BigRational{ ToNumberString(numMagnitude, isNegative), ToNumberString(denMagnitude, false) });
+	}
+	return result;
+}
+
+Fraction Fraction::FromBig(NumberString _numerator, NumberString _denominator) {
+	assert(_denominator != NumberString{});
+	NumberString gcd = ::Gcd(_numerator, _denominator);
+	if (gcd != NumberString{ 1ll }) {
+		_numerator /= gcd; _denominator /= gcd;
+	}
+	if (_denominator < NumberString{}) {
+		_numerator = NumberString{} - _numerator; _denominator = NumberString{} - _denominator;
+	}
+
+	const NumberString maxNative{ LLONG_MAX }, minNative{ -LLONG_MAX };
+	Fraction result;
+	if (_denominator <= maxNative && _numerator <= maxNative && _numerator >= minNative) {
+		result.numerator = std::stoll(_numerator.Get()); result.denominator = std::stoll(_denominator.Get());
+	} else {
+		result.big = std::make_shared<BigRational const>(BigRational{ std::move(_numerator), std::move(_denominator) });
+	}
+	return result;
+}
+
+// a/b ± c/d for reduced operands: with g = gcd(b, d) the numerator
+// t = a*(d/g) ± c*(b/g) can only share factors of g with the denominator, so
+// the result is t/gcd(t, g) over (b/g)*(d/gcd(t, g)) and no product is ever
+// reduced as a whole. The terms are formed in 128-bit, where only the sum of
+// the two products can overflow; that case falls back to NumberString.
+Fraction Fraction::Sum(Fraction const& thisFract, Fraction const& otherFract, bool isDifference) {
+	if (!thisFract.big && !otherFract.big) {
+		ll gcd = static_cast<ll>(Gcd(static_cast<ull>(thisFract.denominator), static_cast<ull>(otherFract.denominator)));
+		ll thisScale = otherFract.denominator, otherScale = thisFract.denominator;
+		if (gcd > 1) {
+			thisScale /= gcd; otherScale /= gcd;
+		}
+		wide first = wide{ thisFract.numerator } * thisScale, second = wide{ otherFract.numerator } * otherScale;
+		wide newNumerator;
+		if (!(isDifference ? __builtin_sub_overflow(first, second, &newNumerator)
+			: __builtin_add_overflow(first, second, &newNumerator))) {
+			ll otherDenominator = otherFract.denominator;
+			if (gcd > 1) {
+				uwide numMagnitude = (newNumerator < 0) ? uwide{ 0 } - static_cast<uwide>(newNumerator) : static_cast<uwide>(newNumerator);
+				ll commonGcd = static_cast<ll>(Gcd(static_cast<ull>(numMagnitude % static_cast<ull>(gcd)), static_cast<ull>(gcd)));
+				if (commonGcd > 1) {
+					newNumerator /= commonGcd; otherDenominator /= commonGcd;
+				}
+			}
+			return FromWide(newNumerator, wide{ otherScale } * otherDenominator);
 		}
 	}
-	return maxDoublePrecision - unusedPrec - wholePart;
+	BigRational first = thisFract.ToBig(), second = otherFract.ToBig();
+	NumberString firstProduct = first.numerator * second.denominator, secondProduct = second.numerator * first.denominator;
+	return FromBig(isDifference ? firstProduct - secondProduct : firstProduct + secondProduct,
+		first.denominator * second.denominator);
+}
+
+Fraction Fraction::FromTerms(ll _numerator, ll _denominator) noexcept {
+	Fraction result;
+	result.numerator = _numerator; result.denominator = _denominator;
+	result.Normalize();
+	return result;
+}
+
+Fraction::BigRational Fraction::ToBig() const {
+	return big ? *big : BigRational{ NumberString{ numerator }, NumberString{ denominator } };
 }
 
-void Fraction::Show() noexcept {
+NumberString Fraction::GetNumerator() const {
+	return big ? big->numerator : NumberString{ numerator };
+}
+
+NumberString Fraction::GetDenominator() const {
+	return big ? big->denominator : NumberString{ denominator };
+}
+
+void Fraction::Show() {
+	if (big) {
+		std::cout << big->numerator << std::endl << big->numerator << '/' << big->denominator << std::endl;
+		return;
+	}
 	AdjustSigns();
 std::cout << numerator << std::endl;
 	if (numerator != 0) {
@@ -103,7 +398,17 @@ std::cout << numerator << std::endl;
 }
 }
 
-constexpr double_t Fraction::ToDecimal() const {
+double_t Fraction::ToDecimal() const {
+	if (big) {
+		// 20 significant digits of the quotient, rounded once by strtod: close
+		// enough that a fraction built from a double converts back to it.
+		const ll quotientDigits = 20;
+		ll scale = static_cast<ll>(CountDigits(big->denominator)) - static_cast<ll>(CountDigits(big->numerator)) + quotientDigits;
+		NumberString power = NumberString{ 10ll } ^ NumberString{ std::abs(scale) };
+		NumberString quotient = (scale >= 0) ? big->numerator * power / big->denominator
+			: big->numerator / (big->denominator * power);
+		return std::strtod((quotient.Get() + 'e' + std::to_string(-scale)).c_str(), nullptr);
+	}
 	if (!denominator) {
 		throw std::overflow_error("Division by zero exception");
 	}
@@ -111,6 +416,9 @@ constexpr double_t Fraction::ToDecimal() const {
 }
 
 Fraction Fraction::Reduced() const {
+	if (big) {
+		return *this;
+	}
 	ll gcd;
 	Fraction reducedFract{ *this };
     gcd = std::gcd(::abs(reducedFract.numerator), ::abs(reducedFract.denominator));
@@ -125,7 +433,7 @@ void Fraction::Reduce() {
 }
 
 void Fraction::AdjustSigns() {
-	if (denominator < 0) {
+	if (!big && denominator < 0) {
 		numerator = -numerator; denominator = -denominator;
 	}
 }
@@ -148,75 +456,127 @@ Fraction& Fraction::operator/= (Fraction const& other) {
 }
 
 
-bool Fraction::operator== (Fraction const& other) const {
-	const double epsilon = 1e-6;
-	return (std::abs(this->ToDecimal() - other.ToDecimal()) <= epsilon);
-}
-
-bool Fraction::operator!= (Fraction const& other) const {
-	return !(*this == other);
+// Both representations are canonical (lowest terms, positive denominator, and
+// big only when a term does not fit into ll), so equal values have equal terms.
+bool Fraction::operator== (Fraction const& other) const noexcept {
+	if (big || other.big) {
+		return big && other.big && big->numerator == other.big->numerator
+			&& big->denominator == other.big->denominator;
+	}
+	return numerator == other.numerator && denominator == other.denominator;
 }
 
-bool Fraction::operator> (Fraction const& other) const {
-	const double epsilon = 1e-6;
-	return (this->ToDecimal() - other.ToDecimal() >= epsilon);
+// a/b <=> c/d is a*d <=> c*b for positive denominators; for native terms both
+// products fit into 128 bits.
+std::strong_ordering Fraction::operator<=> (Fraction const& other) const {
+	if (!big && !other.big) {
+		return wide{ numerator } * other.denominator <=> wide{ other.numerator } * denominator;
+	}
+	BigRational first = ToBig(), second = other.ToBig();
+	NumberString firstProduct = first.numerator * second.denominator, secondProduct = second.numerator * first.denominator;
+	if (firstProduct == secondProduct) {
+		return std::strong_ordering::equal;
+	}
+	return (firstProduct < secondProduct) ? std::strong_ordering::less : std::strong_ordering::greater;
 }
 
-bool Fraction::operator< (Fraction const& other) const {
-	return !(*this == other) && !(*this > other);
+size_t Fraction::Hash() const noexcept {
+	auto combine = [](size_t seed, size_t value) {
+		return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+	};
+	if (big) {
+		return combine(big->numerator.Hash(), big->denominator.Hash());
+	}
+	return combine(std::hash<ll>{}(numerator), std::hash<ll>{}(denominator));
 }
 
 
-Fraction& Fraction::operator-- () noexcept {
-	numerator -= denominator;
+Fraction& Fraction::operator-- () {
+	ll newNumerator;
+	if (big || __builtin_sub_overflow(numerator, denominator, &newNumerator) || newNumerator == LLONG_MIN) {
+		return *this -= Fraction(1);
+	}
+	numerator = newNumerator;
 	return *this;
 }
 
-Fraction& Fraction::operator++ () noexcept {
-	numerator += denominator;
+Fraction& Fraction::operator++ () {
+	ll newNumerator;
+	if (big || __builtin_add_overflow(numerator, denominator, &newNumerator) || newNumerator == LLONG_MIN) {
+		return *this += Fraction(1);
+	}
+	numerator = newNumerator;
 	return *this;
 }
 
-Fraction Fraction::operator-- (int) noexcept {
+Fraction Fraction::operator-- (int) {
 	Fraction tempFract(*this); --(*this);
 	return tempFract;
 }
 
-Fraction Fraction::operator++ (int) noexcept {
+Fraction Fraction::operator++ (int) {
 	Fraction tempFract(*this); ++(*this);
 	return tempFract;
 }
 
 
 Fraction operator+ (Fraction const& thisFract, Fraction const& otherFract) {
-	assert(thisFract.denominator && otherFract.denominator != 0);
-	long long newNumerator = thisFract.numerator * otherFract.denominator +
-		otherFract.numerator * thisFract.denominator;
-	long long newDenominator = thisFract.denominator * otherFract.denominator;
-	return Fraction(newNumerator, newDenominator).Reduced();
+	return Fraction::Sum(thisFract, otherFract, false);
 }
 
 Fraction operator- (Fraction const& thisFract, Fraction const& otherFract) {
-	assert(thisFract.denominator && otherFract.denominator != 0);
-	long long newNumerator = thisFract.numerator * otherFract.denominator -
-		otherFract.numerator * thisFract.denominator;
-	long long newDenominator = thisFract.denominator * otherFract.denominator;
-	return Fraction(newNumerator, newDenominator).Reduced();
+	return Fraction::Sum(thisFract, otherFract, true);
 }
 
+// (a/b) * (c/d) for reduced operands: cancelling gcd(a, d) and gcd(c, b) first
+// leaves a product that is already in lowest terms.
 Fraction operator* (Fraction const& thisFract, Fraction const& otherFract) {
-	assert(thisFract.denominator && otherFract.denominator != 0);
-	return Fraction(thisFract.numerator * otherFract.numerator,
-		thisFract.denominator * otherFract.denominator).Reduced();
+	if (!thisFract.big && !otherFract.big) {
+		auto [firstGcd, secondGcd] = Fraction::GcdPair(
+			Fraction::Magnitude(thisFract.numerator), static_cast<Fraction::ull>(otherFract.denominator),
+			Fraction::Magnitude(otherFract.numerator), static_cast<Fraction::ull>(thisFract.denominator));
+		Fraction::ll thisNumerator = thisFract.numerator, thisDenominator = thisFract.denominator;
+		Fraction::ll otherNumerator = otherFract.numerator, otherDenominator = otherFract.denominator;
+		if (firstGcd > 1) {
+			thisNumerator /= static_cast<Fraction::ll>(firstGcd); otherDenominator /= static_cast<Fraction::ll>(firstGcd);
+		}
+		if (secondGcd > 1) {
+			otherNumerator /= static_cast<Fraction::ll>(secondGcd); thisDenominator /= static_cast<Fraction::ll>(secondGcd);
+		}
+		return Fraction::FromWide(Fraction::wide{ thisNumerator } * otherNumerator,
+			Fraction::wide{ thisDenominator } * otherDenominator);
+	}
+	Fraction::BigRational first = thisFract.ToBig(), second = otherFract.ToBig();
+	return Fraction::FromBig(first.numerator * second.numerator, first.denominator * second.denominator);
 }
 
 Fraction operator/ (Fraction const& thisFract, Fraction const& otherFract) {
-	assert(thisFract.denominator && otherFract.denominator != 0);
-	return Fraction(thisFract.numerator * otherFract.denominator,
-		thisFract.denominator * otherFract.numerator).Reduced();
+	if (!otherFract.big && otherFract.numerator == 0) {
+		throw std::overflow_error("Division by zero exception");
+	}
+	if (!thisFract.big && !otherFract.big) {
+		auto [firstGcd, secondGcd] = Fraction::GcdPair(
+			Fraction::Magnitude(thisFract.numerator), Fraction::Magnitude(otherFract.numerator),
+			static_cast<Fraction::ull>(thisFract.denominator), static_cast<Fraction::ull>(otherFract.denominator));
+		Fraction::ll thisNumerator = thisFract.numerator, thisDenominator = thisFract.denominator;
+		Fraction::ll otherNumerator = otherFract.numerator, otherDenominator = otherFract.denominator;
+		if (firstGcd > 1) {
+			thisNumerator /= static_cast<Fraction::ll>(firstGcd); otherNumerator /= static_cast<Fraction::ll>(firstGcd);
+		}
+		if (secondGcd > 1) {
+			thisDenominator /= static_cast<Fraction::ll>(secondGcd); otherDenominator /= static_cast<Fraction::ll>(secondGcd);
+		}
+		return Fraction::FromWide(Fraction::wide{ thisNumerator } * otherDenominator,
+			Fraction::wide{ thisDenominator } * otherNumerator);
+	}
+	Fraction::BigRational first = thisFract.ToBig(), second = otherFract.ToBig();
+	return Fraction::FromBig(first.numerator * second.denominator, first.denominator * second.numerator);
 }
 
-std::ostream& operator<< (std::ostream& out, Fraction const& fract) noexcept {
+std::ostream& operator<< (std::ostream& out, Fraction const& fract) {
+	if (fract.big) {
+		return (out << fract.big->numerator << '/' << fract.big->denominator << std::endl);
+	}
 	if ((fract.numerator > 0 && fract.denominator < 0)
 	|| (fract.numerator < 0 && fract.denominator > 0)) {
 		out << '-';
@@ -228,12 +588,674 @@ std::ostream& operator<< (std::ostream& out, Fraction const& fract) noexcept {
 std::istream& operator>> (std::istream& in, Fraction& fract) {
 	std::cout << "Enter the fraction ( by the format X/X ) : ";
 	in >> fract.numerator; in.ignore(); in >> fract.denominator;
+	fract.big.reset();
 	assert(fract.denominator != 0);
+	fract.Normalize();
 	return in;
 }
 
+template<> struct std::hash<Fraction> {
+	size_t operator() (Fraction const& fract) const noexcept {
+		return fract.Hash();
+	}
+};
+
+
+// Every per-block kernel below is compiled for AVX-512, AVX2 and baseline x86-64,
+// and the loader picks the widest version the CPU supports.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define FRACTION_ARRAY_KERNEL __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define FRACTION_ARRAY_KERNEL
+#endif
+
+template<class T, size_t Alignment>
+struct AlignedAllocator {
+	typedef T value_type;
+	template<class U> struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+	AlignedAllocator() noexcept = default;
+	template<class U> AlignedAllocator(AlignedAllocator<U, Alignment> const&) noexcept {}
+
+	T* allocate(size_t count) {
+		return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{ Alignment }));
+	}
+	void deallocate(T* pointer, size_t) noexcept {
+		::operator delete(pointer, std::align_val_t{ Alignment });
+	}
+
+	friend bool operator== (AlignedAllocator const&, AlignedAllocator const&) noexcept { return true; }
+};
+
+
+// Native fractions stored column-wise: numerators and denominators (always
+// positive) live in separate aligned arrays, padded with 0/1 to whole blocks.
+// Bulk operations run block by block through branch-free kernels the compiler
+// vectorizes; lanes whose terms all fit into 32 bits are exact there, and the
+// rare wider lanes are redone through Fraction arithmetic. Results are left
+// unreduced until Normalize() reduces all of them in one pass.
+class FractionArray final {
+public:
+	typedef Fraction::ll ll;
+	static constexpr size_t BlockSize = 64;
+	static constexpr size_t Alignment = 64;
+
+public:
+	explicit FractionArray(size_t _size = 0);
+	explicit FractionArray(std::vector<Fraction> const& fractions);
+
+	[[nodiscard]] size_t GetSize() const noexcept { return size; }
+
+	void Set(size_t index, Fraction const& fract);
+	[[nodiscard]] Fraction At(size_t index) const;
+
+	// result[i] = first[i] + second[i] and result[i] = first[i] * second[i]; result may
+	// be one of the operands. A lane whose reduced value does not fit into ll throws
+	// std::overflow_error with result left unspecified.
+	static void Add(FractionArray const& first, FractionArray const& second, FractionArray& result);
+	static void Mul(FractionArray const& first, FractionArray const& second, FractionArray& result);
+	// Multiplies every element by factor.
+	void Scale(Fraction const& factor);
+	// result[i] is the sign of first[i] - second[i].
+	static void Compare(FractionArray const& first, FractionArray const& second, std::vector<int8_t>& result);
+	[[nodiscard]] std::vector<double_t> ToDouble() const;
+
+	// Brings every element to lowest terms; free when nothing changed since the last call.
+	void Normalize() noexcept;
+
+private:
+	typedef std::vector<ll, AlignedAllocator<ll, Alignment>> Column;
+
+	static void CheckSizes(FractionArray const& first, FractionArray const& second, size_t resultSize);
+	void Store(size_t index, Fraction const& fract);
+
+	template<class Kernel, class Exact>
+	void ApplyBlocks(Kernel&& kernel, Exact&& exact);
+
+	FRACTION_ARRAY_KERNEL static bool AddBlock(ll const* __restrict firstNum, ll const* __restrict firstDen,
+		ll const* __restrict secondNum, ll const* __restrict secondDen,
+		ll* __restrict numerators, ll* __restrict denominators, uint8_t* __restrict isWide) noexcept;
+	FRACTION_ARRAY_KERNEL static bool MulBlock(ll const* __restrict firstNum, ll const* __restrict firstDen,
+		ll const* __restrict secondNum, ll const* __restrict secondDen,
+		ll* __restrict numerators, ll* __restrict denominators, uint8_t* __restrict isWide) noexcept;
+	FRACTION_ARRAY_KERNEL static bool CompareBlock(ll const* __restrict firstNum, ll const* __restrict firstDen,
+		ll const* __restrict secondNum, ll const* __restrict secondDen,
+		int8_t* __restrict signs, uint8_t* __restrict isWide) noexcept;
+	FRACTION_ARRAY_KERNEL static void GcdBlock(ll const* __restrict numerators, ll const* __restrict denominators,
+		Fraction::ull* __restrict gcds) noexcept;
+
+	// Whether the term lies in [-2^31, 2^31), where products of two terms and sums of
+	// two such products cannot overflow ll.
+	static bool IsNarrow(ll term) noexcept {
+		return static_cast<Fraction::ull>(term) + (1ull << 31) < (1ull << 32);
+	}
+	static ll NarrowProduct(ll first, ll second) noexcept {
+		return ll{ static_cast<int32_t>(first) } * static_cast<int32_t>(second);
+	}
+
+private:
+	size_t size;
+	Column numerators;
+	Column denominators;
+	bool isNormalized;
+};
+
+
+FractionArray::FractionArray(size_t _size)
+: size(_size), numerators((_size + BlockSize - 1) / BlockSize * BlockSize, 0),
+	denominators(numerators.size(), 1), isNormalized(true) { }
+
+FractionArray::FractionArray(std::vector<Fraction> const& fractions) : FractionArray(fractions.size()) {
+	for (size_t i = 0; i < fractions.size(); ++i) {
+		Set(i, fractions[i]);
+	}
+}
+
+void FractionArray::Set(size_t index, Fraction const& fract) {
+	if (index >= size) {
+		throw std::out_of_range("FractionArray index is out of range");
+	}
+	if (fract.big) {
+		throw std::length_error("Fraction is too large for a FractionArray");
+	}
+	numerators[index] = fract.numerator; denominators[index] = fract.denominator;
+}
+
+Fraction FractionArray::At(size_t index) const {
+	if (index >= size) {
+		throw std::out_of_range("FractionArray index is out of range");
+	}
+	return Fraction::FromTerms(numerators[index], denominators[index]);
+}
+
+void FractionArray::CheckSizes(FractionArray const& first, FractionArray const& second, size_t resultSize) {
+	if (first.size != second.size || resultSize != first.size) {
+		throw std::invalid_argument("FractionArray sizes differ");
+	}
+}
+
+void FractionArray::Store(size_t index, Fraction const& fract) {
+	if (fract.big) {
+		throw std::overflow_error("FractionArray element does not fit into long long");
+	}
+	numerators[index] = fract.numerator; denominators[index] = fract.denominator;
+}
+
+// Runs kernel(from, numerators, denominators, isWide) on every block into scratch
+// columns, redoes the wide lanes with exact(index) while the operands are still
+// intact (result may alias them), and only then writes the block back.
+template<class Kernel, class Exact>
+void FractionArray::ApplyBlocks(Kernel&& kernel, Exact&& exact) {
+	alignas(Alignment) ll blockNumerators[BlockSize];
+	alignas(Alignment) ll blockDenominators[BlockSize];
+	alignas(Alignment) uint8_t isWide[BlockSize];
+	for (size_t from = 0; from < numerators.size(); from += BlockSize) {
+		if (kernel(from, blockNumerators, blockDenominators, isWide)) {
+			for (size_t i = 0; i < BlockSize && from + i < size; ++i) {
+				if (isWide[i]) {
+					Fraction fract = exact(from + i);
+					if (fract.big) {
+						throw std::overflow_error("FractionArray element does not fit into long long");
+					}
+					blockNumerators[i] = fract.numerator; blockDenominators[i] = fract.denominator;
+				}
+			}
+		}
+		std::copy_n(blockNumerators, BlockSize, numerators.data() + from);
+		std::copy_n(blockDenominators, BlockSize, denominators.data() + from);
+	}
+	isNormalized = false;
+}
+
+bool FractionArray::AddBlock(ll const* __restrict firstNum, ll const* __restrict firstDen,
+	ll const* __restrict secondNum, ll const* __restrict secondDen,
+	ll* __restrict numerators, ll* __restrict denominators, uint8_t* __restrict isWide) noexcept {
+	uint8_t anyWide = 0;
+	for (size_t i = 0; i < BlockSize; ++i) {
+		uint8_t wide = !(IsNarrow(firstNum[i]) & IsNarrow(firstDen[i]) & IsNarrow(secondNum[i]) & IsNarrow(secondDen[i]));
+		numerators[i] = NarrowProduct(firstNum[i], secondDen[i]) + NarrowProduct(secondNum[i], firstDen[i]);
+		denominators[i] = NarrowProduct(firstDen[i], secondDen[i]);
+		isWide[i] = wide; anyWide |= wide;
+	}
+	return anyWide;
+}
+
+bool FractionArray::MulBlock(ll const* __restrict firstNum, ll const* __restrict firstDen,
+	ll const* __restrict secondNum, ll const* __restrict secondDen,
+	ll* __restrict numerators, ll* __restrict denominators, uint8_t* __restrict isWide) noexcept {
+	uint8_t anyWide = 0;
+	for (size_t i = 0; i < BlockSize; ++i) {
+		uint8_t wide = !(IsNarrow(firstNum[i]) & IsNarrow(firstDen[i]) & IsNarrow(secondNum[i]) & IsNarrow(secondDen[i]));
+		numerators[i] = NarrowProduct(firstNum[i], secondNum[i]);
+		denominators[i] = NarrowProduct(firstDen[i], secondDen[i]);
+		isWide[i] = wide; anyWide |= wide;
+	}
+	return anyWide;
+}
+
+bool FractionArray::CompareBlock(ll const* __restrict firstNum, ll const* __restrict firstDen,
+	ll const* __restrict secondNum, ll const* __restrict secondDen,
+	int8_t* __restrict signs, uint8_t* __restrict isWide) noexcept {
+	uint8_t anyWide = 0;
+	for (size_t i = 0; i < BlockSize; ++i) {
+		uint8_t wide = !(IsNarrow(firstNum[i]) & IsNarrow(firstDen[i]) & IsNarrow(secondNum[i]) & IsNarrow(secondDen[i]));
+		ll firstProduct = NarrowProduct(firstNum[i], secondDen[i]), secondProduct = NarrowProduct(secondNum[i], firstDen[i]);
+		signs[i] = static_cast<int8_t>((firstProduct > secondProduct) - (firstProduct < secondProduct));
+		isWide[i] = wide; anyWide |= wide;
+	}
+	return anyWide;
+}
+
+void FractionArray::Add(FractionArray const& first, FractionArray const& second, FractionArray& result) {
+	CheckSizes(first, second, result.size);
+	result.ApplyBlocks([&](size_t from, ll* numerators, ll* denominators, uint8_t* isWide) {
+		return AddBlock(first.numerators.data() + from, first.denominators.data() + from,
+			second.numerators.data() + from, second.denominators.data() + from, numerators, denominators, isWide);
+	}, [&](size_t index) { return first.At(index) + second.At(index); });
+}
+
+void FractionArray::Mul(FractionArray const& first, FractionArray const& second, FractionArray& result) {
+	CheckSizes(first, second, result.size);
+	result.ApplyBlocks([&](size_t from, ll* numerators, ll* denominators, uint8_t* isWide) {
+		return MulBlock(first.numerators.data() + from, first.denominators.data() + from,
+			second.numerators.data() + from, second.denominators.data() + from, numerators, denominators, isWide);
+	}, [&](size_t index) { return first.At(index) * second.At(index); });
+}
+
+void FractionArray::Scale(Fraction const& factor) {
+	if (factor.big) {
+		throw std::length_error("Fraction is too large for a FractionArray");
+	}
+	alignas(Alignment) ll factorNumerators[BlockSize], factorDenominators[BlockSize];
+	std::fill_n(factorNumerators, BlockSize, factor.numerator);
+	std::fill_n(factorDenominators, BlockSize, factor.denominator);
+	ApplyBlocks([&](size_t from, ll* blockNumerators, ll* blockDenominators, uint8_t* isWide) {
+		return MulBlock(numerators.data() + from, denominators.data() + from,
+			factorNumerators, factorDenominators, blockNumerators, blockDenominators, isWide);
+	}, [&](size_t index) { return At(index) * factor; });
+}
+
+void FractionArray::Compare(FractionArray const& first, FractionArray const& second, std::vector<int8_t>& result) {
+	CheckSizes(first, second, first.size);
+	result.resize(first.numerators.size());
+	alignas(Alignment) uint8_t isWide[BlockSize];
+	for (size_t from = 0; from < first.numerators.size(); from += BlockSize) {
+		if (!CompareBlock(first.numerators.data() + from, first.denominators.data() + from,
+			second.numerators.data() + from, second.denominators.data() + from, result.data() + from, isWide)) {
+			continue;
+		}
+		for (size_t i = 0; i < BlockSize; ++i) {
+			if (isWide[i]) {
+				Fraction::wide firstProduct = Fraction::wide{ first.numerators[from + i] } * second.denominators[from + i];
+				Fraction::wide secondProduct = Fraction::wide{ second.numerators[from + i] } * first.denominators[from + i];
+				result[from + i] = static_cast<int8_t>((firstProduct > secondProduct) - (firstProduct < secondProduct));
+			}
+		}
+	}
+	result.resize(first.size);
+}
+
+std::vector<double_t> FractionArray::ToDouble() const {
+	std::vector<double_t> result(size);
+	for (size_t i = 0; i < size; ++i) {
+		result[i] = static_cast<double_t>(numerators[i]) / static_cast<double_t>(denominators[i]);
+	}
+	return result;
+}
+
+// Stein's gcd run on a whole block at once: every round makes one branch-free
+// step in all lanes, so it vectorizes, and the rounds stop when the slowest lane
+// is done. Trailing zeros are counted through the leading zeros of the lowest
+// set bit, which AVX-512 has as a vector instruction.
+void FractionArray::GcdBlock(ll const* __restrict numerators, ll const* __restrict denominators,
+	Fraction::ull* __restrict gcds) noexcept {
+	typedef Fraction::ull ull;
+	auto countTrailingZeros = [](ull term) -> ull { return 63 - std::countl_zero((term & (0ull - term)) | 1); };
+	alignas(Alignment) ull odd[BlockSize], rest[BlockSize], shifts[BlockSize];
+	for (size_t i = 0; i < BlockSize; ++i) {
+		// gcd(0, d) = d, and denominators are never 0.
+		ull first = Fraction::Magnitude(numerators[i]), second = static_cast<ull>(denominators[i]);
+		first |= second & (0ull - ull{ first == 0 });
+		shifts[i] = countTrailingZeros(first | second);
+		odd[i] = first >> countTrailingZeros(first);
+		rest[i] = second;
+	}
+	for (ull isRunning = 1; isRunning; ) {
+		isRunning = 0;
+		for (size_t i = 0; i < BlockSize; ++i) {
+			ull second = rest[i] >> countTrailingZeros(rest[i]), mask = 0ull - ull{ second != 0 };
+			ull smaller = std::min(odd[i], second), larger = std::max(odd[i], second);
+			odd[i] = (smaller & mask) | (odd[i] & ~mask);
+			rest[i] = (larger - smaller) & mask;
+			isRunning |= rest[i];
+		}
+	}
+	for (size_t i = 0; i < BlockSize; ++i) {
+		gcds[i] = odd[i] << shifts[i];
+	}
+}
+
+void FractionArray::Normalize() noexcept {
+	if (isNormalized) {
+		return;
+	}
+	alignas(Alignment) Fraction::ull gcds[BlockSize];
+	for (size_t from = 0; from < numerators.size(); from += BlockSize) {
+		GcdBlock(numerators.data() + from, denominators.data() + from, gcds);
+		for (size_t i = 0; i < BlockSize; ++i) {
+			if (gcds[i] > 1) {
+				numerators[from + i] /= static_cast<ll>(gcds[i]); denominators[from + i] /= static_cast<ll>(gcds[i]);
+			}
+		}
+	}
+	isNormalized = true;
+}
+
+
+// Time per operator on two operand sets: random 31-bit terms, which are mostly
+// coprime, and decimal fractions n/10^k like those the double constructor
+// produces, whose denominators share most of their factors; then sorting the
+// first set, converting random doubles and deduplicating the second set through
+// a hash set.
+void BenchmarkFractions(size_t operations) {
+	std::mt19937 generator(42);
+	std::uniform_int_distribution<int32_t> numerators(-INT32_MAX, INT32_MAX), denominators(1, INT32_MAX);
+	std::uniform_int_distribution<int32_t> decimals(-999999999, 999999999), decimalDigits(0, 9);
+	std::vector<Fraction> random, decimal, results(operations);
+	random.reserve(operations + 1); decimal.reserve(operations + 1);
+	for (size_t i = 0; i <= operations; ++i) {
+		random.emplace_back(numerators(generator), denominators(generator));
+		decimal.emplace_back(decimals(generator), static_cast<int32_t>(std::pow(10, decimalDigits(generator))));
+	}
+
+	auto measure = [&](char const* name, auto const& operands, auto&& operation) {
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < operations; ++i) {
+			results[i] = operation(operands[i], operands[i + 1]);
+		}
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		double checksum = 0;
+		for (auto const& result : results) {
+			checksum += result.ToDecimal();
+		}
+		std::cout << name << ": " << elapsed.count() / static_cast<double>(operations) << " ns/op (checksum "
+			<< checksum << ')' << std::endl;
+	};
+	for (auto const& [set, operands] : { std::pair{ "random", &random }, std::pair{ "decimal", &decimal } }) {
+		std::cout << set << " operands" << std::endl;
+		measure("  Add", *operands, [](Fraction const& a, Fraction const& b) { return a + b; });
+		measure("  Subtract", *operands, [](Fraction const& a, Fraction const& b) { return a - b; });
+		measure("  Multiply", *operands, [](Fraction const& a, Fraction const& b) { return a * b; });
+		measure("  Divide", *operands, [](Fraction const& a, Fraction const& b) { return a / b; });
+	}
+
+	// The same decimal sums and products as columns; the checksums must match the scalar ones.
+	FractionArray first(std::vector<Fraction>(decimal.begin(), decimal.end() - 1));
+	FractionArray second(std::vector<Fraction>(decimal.begin() + 1, decimal.end())), result(operations);
+	auto measureArray = [&](char const* name, auto&& operation) {
+		auto start = std::chrono::steady_clock::now();
+		operation();
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		double checksum = 0;
+		for (double_t value : result.ToDouble()) {
+			checksum += value;
+		}
+		std::cout << name << ": " << elapsed.count() / static_cast<double>(operations) << " ns/element (checksum "
+			<< checksum << ')' << std::endl;
+	};
+	std::cout << "decimal FractionArray" << std::endl;
+	measureArray("  Add", [&] { FractionArray::Add(first, second, result); });
+	measureArray("  Add + Normalize", [&] { FractionArray::Add(first, second, result); result.Normalize(); });
+	measureArray("  Multiply", [&] { FractionArray::Mul(first, second, result); });
+	measureArray("  Multiply + Normalize", [&] { FractionArray::Mul(first, second, result); result.Normalize(); });
+	result = first;
+	measureArray("  Scale + Normalize", [&] { result.Scale(Fraction(3, 7)); result.Normalize(); });
+
+	std::vector<int8_t> signs;
+	auto start = std::chrono::steady_clock::now();
+	FractionArray::Compare(first, second, signs);
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "  Compare: " << elapsed.count() / static_cast<double>(operations) << " ns/element ("
+		<< std::count(signs.begin(), signs.end(), int8_t{ -1 }) << " less)" << std::endl;
+
+	start = std::chrono::steady_clock::now();
+	std::vector<double_t> converted = first.ToDouble();
+	elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "  To double: " << elapsed.count() / static_cast<double>(operations) << " ns/element" << std::endl;
+
+	std::uniform_real_distribution<double_t> doubles(-1e6, 1e6);
+	std::vector<double_t> values(operations + 1);
+	std::generate(values.begin(), values.end(), [&] { return doubles(generator); });
+	measure("From double", values, [](double_t value, double_t) { return Fraction(value); });
+
+	start = std::chrono::steady_clock::now();
+	std::sort(random.begin(), random.end());
+	elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "Sort: " << elapsed.count() / static_cast<double>(random.size()) << " ns/element" << std::endl;
+
+	start = std::chrono::steady_clock::now();
+	std::unordered_set<Fraction> unique(decimal.begin(), decimal.end());
+	elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "Hash set: " << elapsed.count() / static_cast<double>(decimal.size()) << " ns/element ("
+		<< unique.size() << " distinct)" << std::endl;
+}
+
+
+// Behaviour checks run by Fraction --test. Every failed check is reported, and the
+// exit status is nonzero if any failed.
+size_t failedChecks = 0;
+
+void Check(bool condition, char const* description) {
+	if (!condition) {
+		std::cerr << "FAILED: " << description << std::endl;
+		++failedChecks;
+	}
+}
+
+bool HasTerms(Fraction const& fract, char const* numerator, char const* denominator) {
+	return fract.GetNumerator().Get() == numerator && fract.GetDenominator().Get() == denominator;
+}
+
+void TestOverflowPromotion() {
+	Fraction const one(1), max(NumberString{ LLONG_MAX }, NumberString{ 1ll });
+	Fraction const negativeMax(NumberString{ -LLONG_MAX }, NumberString{ 1ll });
+
+	Fraction promoted = max + one;
+	Check(HasTerms(promoted, "9223372036854775808", "1"), "LLONG_MAX + 1 is promoted to a big rational");
+	Fraction demoted = promoted - one;
+	Check(HasTerms(demoted, "9223372036854775807", "1") && demoted == max, "LLONG_MAX + 1 - 1 is demoted again");
+	Check(demoted.Hash() == max.Hash(), "a demoted value hashes like the native one");
+
+	Fraction minimum = negativeMax - one;
+	Check(HasTerms(minimum, "-9223372036854775808", "1"), "-LLONG_MAX - 1 is exact");
+	Check(minimum + one == negativeMax, "LLONG_MIN + 1 is demoted to -LLONG_MAX");
+
+	Fraction third = max / Fraction(3);
+	Check(HasTerms(third + third, "18446744073709551614", "3"), "LLONG_MAX/3 + LLONG_MAX/3");
+	Check(max * max / max == max, "LLONG_MAX * LLONG_MAX / LLONG_MAX");
+	Check(HasTerms(Fraction(1, 3) / max / max, "1", "255211775190703847542190723352697503747"),
+		"denominator beyond 2^127");
+
+	Fraction counter = max;
+	++counter;
+	Check(HasTerms(counter, "9223372036854775808", "1"), "++ past LLONG_MAX");
+	--counter;
+	Check(counter == max, "-- back to LLONG_MAX");
+
+	try {
+		(void)(max / Fraction(0));
+		Check(false, "division by zero throws");
+	} catch (std::overflow_error const&) {}
+}
+
+// Sums of fractions with different denominators that cancel out must give the
+// canonical zero 0/1, for native and for big terms alike.
+void TestZeroSums() {
+	Check(HasTerms(Fraction(1, 2) - Fraction(1, 3) - Fraction(1, 6), "0", "1"), "1/2 - 1/3 - 1/6");
+	Check(HasTerms(Fraction(-7, 12) + Fraction(5, 18) + Fraction(11, 36), "0", "1"), "-7/12 + 5/18 + 11/36");
+
+	Fraction big(NumberString{ "18446744073709551617" }, NumberString{ "3" });
+	Fraction half = big / Fraction(2);
+	Check(HasTerms(big - half - half, "0", "1"), "big - big/2 - big/2");
+	Check(HasTerms(half + half - big, "0", "1") && half + half - big == Fraction(), "big/2 + big/2 - big");
+	Check((big - big).Hash() == Fraction().Hash(), "a big zero hashes like 0");
+}
+
+// Cross-reduction keeps results native whenever the reduced value fits, even
+// when the unreduced products of the terms would not.
+void TestCrossReduction() {
+	Fraction const max(NumberString{ LLONG_MAX }, NumberString{ 1ll });
+	Fraction const large(NumberString{ "4611686018427387903" }, NumberString{ "4611686018427387847" });
+	Fraction const reciprocal(NumberString{ "4611686018427387847" }, NumberString{ "4611686018427387903" });
+
+	Check(HasTerms(large * reciprocal, "1", "1"), "x * 1/x with 62-bit terms");
+	Check(HasTerms(large / large, "1", "1"), "x / x with 62-bit terms");
+	Check(HasTerms(max / Fraction(2) * (Fraction(2) / max), "1", "1"), "LLONG_MAX/2 * 2/LLONG_MAX");
+	Check(HasTerms(max / Fraction(3) / (max / Fraction(9)), "3", "1"), "(LLONG_MAX/3) / (LLONG_MAX/9)");
+
+	Fraction const tiny(NumberString{ 1ll }, NumberString{ 1ll << 62 });
+	Check(HasTerms(tiny + tiny, "1", "2305843009213693952"), "1/2^62 + 1/2^62");
+	Check(HasTerms(tiny - tiny / Fraction(2), "1", "9223372036854775808"), "1/2^62 - 1/2^63");
+	Check(HasTerms(Fraction(6, -4), "-3", "2") && HasTerms(Fraction(-8, -12) * Fraction(9, 4), "3", "2"),
+		"int32 terms are reduced and signs normalized");
+}
+
+// Neighbouring values below the resolution of a double still compare exactly,
+// and equal values built in different ways collapse in a hash set.
+void TestOrderingAndHash() {
+	Fraction const above(NumberString{ LLONG_MAX }, NumberString{ LLONG_MAX - 1 });
+	Fraction const below(NumberString{ LLONG_MAX - 1 }, NumberString{ LLONG_MAX - 2 });
+	Check(above.ToDecimal() == below.ToDecimal(), "the neighbours are equal as doubles");
+	Check(above < below && below > above && above != below, "neighbours 1/2^126 apart are ordered exactly");
+
+	Fraction const huge(NumberString{ "100000000000000000000000000001" }, NumberString{ 3ll });
+	Fraction const hugeNeighbour(NumberString{ "100000000000000000000000000002" }, NumberString{ 3ll });
+	Check(huge < hugeNeighbour && (hugeNeighbour <=> huge) == std::strong_ordering::greater, "big neighbours");
+	Check(Fraction(-1) < huge && Fraction(INT32_MAX) < huge && !(huge < Fraction(INT32_MAX)), "native below big");
+
+	std::vector<Fraction> values{ huge, Fraction(-1, 2), above, Fraction(0), below, Fraction(-3, 2), hugeNeighbour };
+	std::sort(values.begin(), values.end());
+	std::vector<Fraction> const sorted{ Fraction(-3, 2), Fraction(-1, 2), Fraction(0), above, below, huge,
+		hugeNeighbour };
+	Check(values == sorted, "std::sort orders native and big values");
+
+	std::unordered_set<Fraction> const unique{ Fraction(1, 2), Fraction(2, 4), Fraction(0.5), Fraction(-3, -6),
+		Fraction(NumberString{ "50000000000000000000" }, NumberString{ "100000000000000000000" }),
+		huge, huge + Fraction(1) - Fraction(1) };
+	Check(unique.size() == 2, "equal values hash alike however they were built");
+	Check(huge.Hash() != hugeNeighbour.Hash() && huge.Hash() != (Fraction(0) - huge).Hash(),
+		"big values differing in one limb or in sign hash apart");
+}
+
+void TestDoubleConversion() {
+	Check(HasTerms(Fraction(0.1), "3602879701896397", "36028797018963968"), "0.1 is converted exactly");
+	Check(HasTerms(Fraction(std::ldexp(1.0, 63)), "9223372036854775808", "1"), "2^63");
+	Check(HasTerms(Fraction(-std::ldexp(1.0, 63)), "-9223372036854775808", "1"), "-2^63");
+	Check(HasTerms(Fraction(-0.0), "0", "1"), "-0.0 is zero");
+	Fraction const smallest(std::ldexp(1.0, -1074));
+	Check(smallest.GetNumerator().Get() == "1"
+		&& smallest.GetDenominator() == (NumberString{ 2ll } ^ NumberString{ 1074ll }), "smallest subnormal");
+
+	double_t const values[]{ 0.1, -0.1, 1.0 / 3, std::ldexp(1.0, 63), -std::ldexp(1.0, 63), std::ldexp(1.0, -1074),
+		-std::ldexp(0.75, -1030), std::ldexp(1.0, -1022), 1.7976931348623157e308, 123456.789, -0.0 };
+	bool isRoundTrip = true;
+	for (double_t value : values) {
+		isRoundTrip = isRoundTrip && Fraction(value).ToDecimal() == value;
+	}
+	Check(isRoundTrip, "doubles round-trip through Fraction and ToDecimal");
+
+	try {
+		(void)Fraction(std::nan(""));
+		Check(false, "NaN throws");
+	} catch (std::domain_error const&) {}
+	try {
+		(void)Fraction(-HUGE_VAL);
+		Check(false, "infinity throws");
+	} catch (std::domain_error const&) {}
+}
+
+// Expected values are those of Python's fractions.Fraction(x).limit_denominator(bound).
+void TestApproximate() {
+	double_t const pi = 3.141592653589793;
+	Check(HasTerms(Fraction::Approximate(pi, 10), "22", "7"), "pi within 10");
+	Check(HasTerms(Fraction::Approximate(pi, 100), "311", "99"), "pi within 100");
+	Check(HasTerms(Fraction::Approximate(pi, 1000), "355", "113"), "pi within 1000");
+	Check(HasTerms(Fraction::Approximate(pi, 1000000), "3126535", "995207"), "pi within 10^6");
+	Check(HasTerms(Fraction::Approximate(0.1, 1000), "1", "10"), "0.1 within 1000");
+	Check(HasTerms(Fraction::Approximate(-1.4142135623730951, 100), "-140", "99"), "-sqrt(2) within 100");
+	Check(HasTerms(Fraction::Approximate(2.718281828459045, 1000000000), "1032595833", "379870778"),
+		"e within 10^9");
+	Check(HasTerms(Fraction::Approximate(1e-30, 1000000000000000000), "0", "1"), "1e-30 within 10^18");
+	Check(HasTerms(Fraction::Approximate(0.5, 1), "0", "1"), "a tie within 1");
+	Check(HasTerms(Fraction::Approximate(2.0 / 3, 7), "2", "3"), "2/3 within 7");
+	Check(Fraction::Approximate(0.375, 8) == Fraction(3, 8), "exact when the denominator fits");
+
+	try {
+		(void)Fraction::Approximate(pi, 0);
+		Check(false, "a bound below 1 throws");
+	} catch (std::invalid_argument const&) {}
+}
+
+// Every bulk result must equal the scalar operators lane by lane. The lanes span
+// several blocks and mix 32-bit terms with wider ones that take the exact path.
+void TestFractionArray() {
+	size_t const size = 2 * FractionArray::BlockSize + 5;
+	std::vector<Fraction> first, second;
+	for (size_t i = 0; i < size; ++i) {
+		auto lane = static_cast<int32_t>(i);
+		first.emplace_back(lane * 7919 - 500000, lane % 97 + 1);
+		second.push_back((i % 5 == 0)
+			? Fraction(NumberString{ (1ll << 33) + lane }, NumberString{ lane % 3 + 1ll })
+			: Fraction(lane * 100003 - 7000000, lane % 13 + 2));
+	}
+
+	auto matches = [&](FractionArray const& array, auto&& operation) {
+		bool isEqual = array.GetSize() == size;
+		for (size_t i = 0; i < size && isEqual; ++i) {
+			isEqual = array.At(i) == operation(first[i], second[i]);
+		}
+		return isEqual;
+	};
+	FractionArray const firstArray(first), secondArray(second);
+	FractionArray result(size);
+	FractionArray::Add(firstArray, secondArray, result);
+	Check(matches(result, [](Fraction const& a, Fraction const& b) { return a + b; }), "bulk Add");
+	FractionArray::Mul(firstArray, secondArray, result);
+	result.Normalize();
+	Check(matches(result, [](Fraction const& a, Fraction const& b) { return a * b; }), "bulk Mul");
+
+	FractionArray aliased(first);
+	FractionArray::Add(aliased, secondArray, aliased);
+	FractionArray::Mul(firstArray, aliased, aliased);
+	Check(matches(aliased, [](Fraction const& a, Fraction const& b) { return a * (a + b); }),
+		"bulk Add and Mul into an aliased result");
+
+	FractionArray scaled(first);
+	scaled.Scale(Fraction(-3, 7));
+	Check(matches(scaled, [](Fraction const& a, Fraction const&) { return a * Fraction(-3, 7); }), "Scale");
+
+	std::vector<int8_t> signs;
+	FractionArray::Compare(firstArray, secondArray, signs);
+	bool isCompared = signs.size() == size;
+	for (size_t i = 0; i < size && isCompared; ++i) {
+		isCompared = signs[i] == ((first[i] > second[i]) - (first[i] < second[i]));
+	}
+	Check(isCompared, "Compare");
+
+	std::vector<double_t> values = firstArray.ToDouble();
+	Check(values.size() == size && values[size - 1] == first[size - 1].ToDecimal(), "ToDouble");
+
+	// One lane whose sum no longer fits into long long makes the operation throw.
+	FractionArray overflowing(first);
+	overflowing.Set(size - 2, Fraction(NumberString{ LLONG_MAX }, NumberString{ 1ll }));
+	FractionArray ones(std::vector<Fraction>(size, Fraction(1)));
+	try {
+		FractionArray::Add(overflowing, ones, result);
+		Check(false, "an overflowing lane throws");
+	} catch (std::overflow_error const&) {}
+	FractionArray::Mul(overflowing, ones, result);
+	Check(result.At(size - 2) == Fraction(NumberString{ LLONG_MAX }, NumberString{ 1ll }), "LLONG_MAX * 1 fits");
+
+	try {
+		FractionArray::Add(firstArray, FractionArray(size - 1), result);
+		Check(false, "different sizes throw");
+	} catch (std::invalid_argument const&) {}
+	try {
+		result.Set(0, Fraction(NumberString{ "100000000000000000000" }, NumberString{ 1ll }));
+		Check(false, "a big fraction cannot be stored");
+	} catch (std::length_error const&) {}
+	try {
+		(void)result.At(size);
+		Check(false, "At past the end throws");
+	} catch (std::out_of_range const&) {}
+}
+
+int RunTests() {
+	TestOverflowPromotion();
+	TestZeroSums();
+	TestCrossReduction();
+	TestOrderingAndHash();
+	TestDoubleConversion();
+	TestApproximate();
+	TestFractionArray();
+
+	if (failedChecks != 0) {
+		std::cerr << failedChecks << " check(s) failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
+
 
 int main(int argc, char** argv) {
+	if (argc > 1 && std::string_view{ argv[1] } == "--bench") {
+		BenchmarkFractions((argc > 2) ? std::stoul(argv[2]) : 1000000);
+		return 0;
+	}
+	if (argc > 1 && std::string_view{ argv[1] } == "--test") {
+		return RunTests();
+	}
 
     try {
         Fraction fraction{ 5, 0
@@ -252,7 +1274,7 @@ int main(int argc, char** argv) {
 	std::cout << std::fixed << std::setprecision(5)
 		<< (--((fu / Fraction(78.1e-8)).Reduced())).ToDecimal() << std::endl;
 
-	Fraction fract{ 3456e-6 };
+	Fraction fract{ Fraction::Approximate(3456e-6, 1000000) };
 	fract *= Fraction{ 34, -24552 };
 
 	std::cout << fract << std::fixed << std::setprecision(10);
@@ -260,6 +1282,12 @@ int main(int argc, char** argv) {
 	std::cout << (fract++).ToDecimal() << std::endl;
 	std::cout << fract.ToDecimal() << std::endl;
 
+	Fraction harmonic;
+	for (int32_t i = 1; i <= 60; ++i) {
+		harmonic += Fraction(1, i);
+	}
+	std::cout << harmonic << harmonic.ToDecimal() << std::endl;
+
 	std::cin.get();
 	return 0;
 }